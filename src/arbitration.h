@@ -0,0 +1,17 @@
+#ifndef ARBITRATION_H
+#define ARBITRATION_H
+
+#include <string>
+
+// How the bus picks the next core among those with a queued request
+enum class ArbitrationPolicy {
+    RoundRobin,    // Rotate through the cores (the default)
+    OldestFirst,   // Smallest BusRequest::request_cycle wins; ties rotate
+    FixedPriority, // First ready core in a fixed order
+    WeightedFair   // Grants in proportion to per-core QoS weights (stride scheduling)
+};
+
+// Throws std::invalid_argument for anything other than "rr", "oldest", "priority" or "weighted"
+ArbitrationPolicy parseArbitrationPolicy(const std::string &name);
+
+#endif
@@ -0,0 +1,369 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <unordered_set>
+#include <unistd.h> // For getopt
+
+#include "simulator.h"
+#include "cli_options.h"
+
+// Runs a list of L1simulate configurations on a pool of threads and appends one JSON
+// object per finished job to a results file. Each job-list line holds L1simulate
+// arguments; jobs that already have an "ok" result in the file are skipped.
+// Exit status: 0 all jobs succeeded, 1 some job failed, 2 usage or I/O error.
+
+namespace
+{
+struct Job
+{
+    size_t line = 0;
+    std::string args; // Whitespace-normalised argument string, also the cache key
+    SimConfig config;
+};
+
+std::string jsonEscape(const std::string &text)
+{
+    std::ostringstream out;
+    for (unsigned char c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if (c < 0x20)
+            {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+            }
+            else
+            {
+                out << c;
+            }
+        }
+    }
+    return out.str();
+}
+
+// The job key of a result line written by formatResult, or "" if the line is not a
+// successful result
+std::string finishedJobKey(const std::string &line)
+{
+    const std::string prefix = "{\"job\":\"";
+    if (line.compare(0, prefix.size(), prefix) != 0 || line.find("\"status\":\"ok\"") == std::string::npos)
+    {
+        return "";
+    }
+    std::string key;
+    for (size_t i = prefix.size(); i < line.size(); ++i)
+    {
+        if (line[i] == '"')
+        {
+            return key;
+        }
+        if (line[i] == '\\' && i + 1 < line.size())
+        {
+            char escaped = line[++i];
+            key += (escaped == 'n') ? '\n' : (escaped == 't') ? '\t' : escaped;
+            continue;
+        }
+        key += line[i];
+    }
+    return "";
+}
+
+// Parses each line with the L1simulate option parser. Blank lines and '#' comments are
+// skipped; bad lines are reported and counted in failures.
+std::vector<Job> loadJobs(std::istream &in, int &failures)
+{
+    std::vector<Job> jobs;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(in, line))
+    {
+        ++line_number;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+        {
+            line.erase(hash);
+        }
+        std::istringstream fields(line);
+        std::vector<std::string> args = {"L1simulate"};
+        std::string field;
+        while (fields >> field)
+        {
+            args.push_back(field);
+        }
+        if (args.size() == 1)
+        {
+            continue;
+        }
+
+        Job job;
+        job.line = line_number;
+        for (size_t i = 1; i < args.size(); ++i)
+        {
+            job.args += (i > 1 ? " " : "") + args[i];
+        }
+        std::vector<char *> argv;
+        for (std::string &arg : args)
+        {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+        try
+        {
+            if (!parseCommandLine(static_cast<int>(args.size()), argv.data(), job.config))
+            {
+                throw CommandLineError("-h is not a job");
+            }
+            jobs.push_back(std::move(job));
+        }
+        catch (const CommandLineError &e)
+        {
+            std::cerr << "Job list line " << line_number << ": " << e.what() << std::endl;
+            failures++;
+        }
+    }
+    return jobs;
+}
+
+// Each worker takes jobs from the front of its own queue and, once that is empty,
+// steals from the back of the others'. Jobs are whole simulations, so a lock per
+// queue costs nothing measurable.
+class WorkStealingQueues
+{
+private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<size_t> jobs;
+    };
+    std::vector<Queue> queues;
+
+public:
+    WorkStealingQueues(size_t workers, size_t job_count) : queues(workers)
+    {
+        for (size_t i = 0; i < job_count; ++i)
+        {
+            queues[i % workers].jobs.push_back(i);
+        }
+    }
+
+    bool next(size_t worker, size_t &job)
+    {
+        for (size_t k = 0; k < queues.size(); ++k)
+        {
+            Queue &queue = queues[(worker + k) % queues.size()];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (queue.jobs.empty())
+            {
+                continue;
+            }
+            if (k == 0)
+            {
+                job = queue.jobs.front();
+                queue.jobs.pop_front();
+            }
+            else
+            {
+                job = queue.jobs.back();
+                queue.jobs.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+std::string formatResult(const Job &job, const Simulator &sim, double wall_seconds)
+{
+    const SimConfig &config = sim.getConfig();
+    const Stats &stats = sim.getStats();
+    uint64_t accesses = 0;
+    for (int i = 0; i < NUM_CORES; ++i)
+    {
+        accesses += sim.getCoreStats(i).accesses;
+    }
+    cycle_t cycles = sim.getMaxCycles();
+
+    std::ostringstream out;
+    out << "{\"job\":\"" << jsonEscape(job.args) << "\",\"status\":\"ok\""
+        << ",\"trace\":\"" << jsonEscape(config.manifest_path.empty() ? config.trace_base_name : config.manifest_path) << "\""
+        << ",\"s\":" << config.s << ",\"E\":" << config.E << ",\"b\":" << config.b
+        << ",\"cores\":" << NUM_CORES
+        << ",\"cycles\":" << cycles
+        << ",\"bus_transactions\":" << sim.getBusTransactions()
+        << ",\"bus_traffic_bytes\":" << stats.total_bus_traffic_bytes
+        << ",\"wall_seconds\":" << wall_seconds
+        << ",\"cycles_per_second\":" << (wall_seconds > 0 ? cycles / wall_seconds : 0.0)
+        << ",\"accesses_per_second\":" << (wall_seconds > 0 ? accesses / wall_seconds : 0.0)
+        << ",\"per_core\":[";
+    for (int i = 0; i < NUM_CORES; ++i)
+    {
+        CoreStatsSummary core = sim.getCoreStats(i);
+        out << (i ? "," : "") << "{\"reads\":" << core.reads << ",\"writes\":" << core.writes
+            << ",\"misses\":" << core.misses << ",\"miss_rate\":" << core.miss_rate
+            << ",\"evictions\":" << core.evictions << ",\"writebacks\":" << core.writebacks
+            << ",\"invalidations_received\":" << core.invalidations_received
+            << ",\"data_traffic_bytes\":" << core.data_traffic_bytes
+            << ",\"execution_cycles\":" << core.execution_cycles << ",\"idle_cycles\":" << core.idle_cycles << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [-j <threads>] <joblist> <results.jsonl>" << std::endl;
+    std::cerr << "  Each job-list line holds L1simulate arguments (e.g. -t app1 -s 6 -E 2 -b 5)." << std::endl;
+    std::cerr << "  Results are appended as JSON lines; jobs with a result already there are skipped." << std::endl;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    long threads = std::thread::hardware_concurrency();
+    int opt;
+    while ((opt = getopt(argc, argv, "j:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            try
+            {
+                threads = std::stol(optarg);
+            }
+            catch (...)
+            {
+                threads = 0;
+            }
+            if (threads <= 0)
+            {
+                std::cerr << "Error: Thread count (-j) must be positive." << std::endl;
+                return 2;
+            }
+            break;
+        default:
+            printUsage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (argc - optind != 2)
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+    std::string joblist_path = argv[optind];
+    std::string results_path = argv[optind + 1];
+    threads = std::max(1L, threads);
+
+    std::ifstream joblist(joblist_path);
+    if (!joblist)
+    {
+        std::cerr << "Error: Cannot open job list " << joblist_path << std::endl;
+        return 2;
+    }
+    int failures = 0;
+    std::vector<Job> all_jobs = loadJobs(joblist, failures);
+
+    std::unordered_set<std::string> finished;
+    {
+        std::ifstream previous(results_path);
+        std::string line;
+        while (std::getline(previous, line))
+        {
+            std::string key = finishedJobKey(line);
+            if (!key.empty())
+            {
+                finished.insert(key);
+            }
+        }
+    }
+    std::vector<Job> jobs;
+    for (Job &job : all_jobs)
+    {
+        if (!finished.count(job.args))
+        {
+            jobs.push_back(std::move(job));
+        }
+    }
+    size_t skipped = all_jobs.size() - jobs.size();
+
+    std::ofstream results(results_path, std::ios::app);
+    if (!results)
+    {
+        std::cerr << "Error: Cannot open results file " << results_path << std::endl;
+        return 2;
+    }
+
+    WorkStealingQueues queues(static_cast<size_t>(threads), jobs.size());
+    std::mutex output_lock;
+    std::atomic<int> failed{0};
+    size_t done = 0;
+    auto batch_start = std::chrono::steady_clock::now();
+
+    auto worker = [&](size_t worker_id) {
+        size_t index;
+        while (queues.next(worker_id, index))
+        {
+            const Job &job = jobs[index];
+            std::string record;
+            auto start = std::chrono::steady_clock::now();
+            try
+            {
+                Simulator sim(job.config);
+                sim.run();
+                double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                record = formatResult(job, sim, wall_seconds);
+            }
+            catch (const std::exception &e)
+            {
+                record = "{\"job\":\"" + jsonEscape(job.args) + "\",\"status\":\"error\",\"error\":\"" + jsonEscape(e.what()) + "\"}";
+                failed++;
+            }
+
+            // Flushed per job, so an interrupted batch keeps everything that finished
+            std::lock_guard<std::mutex> guard(output_lock);
+            results << record << '\n';
+            results.flush();
+            ++done;
+            std::cerr << "[" << done << "/" << jobs.size() << "] " << job.args << std::endl;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    size_t pool_size = std::min(static_cast<size_t>(threads), std::max<size_t>(1, jobs.size()));
+    for (size_t i = 0; i < pool_size; ++i)
+    {
+        pool.emplace_back(worker, i);
+    }
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batch_start).count();
+    failures += failed;
+    std::cerr << "Ran " << jobs.size() << " job" << (jobs.size() == 1 ? "" : "s") << " on " << pool_size
+              << " thread" << (pool_size == 1 ? "" : "s") << " in " << std::fixed << std::setprecision(2) << total_seconds
+              << " s (" << skipped << " cached, " << failures << " failed)" << std::endl;
+    return failures ? 1 : 0;
+}
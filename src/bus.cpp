@@ -1,14 +1,47 @@
 #include "bus.h"
 #include "cache.h"
 #include "stats.h"
+#include "checkpoint.h"
+#include "profile.h"
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
+#include <bit>
 
-Bus::Bus(unsigned int block_size, Stats *statistics) : requests_per_core(NUM_CORES),
-                                                       core_priority_order(NUM_CORES),
-                                                       block_size_bytes(block_size),
-                                                       words_per_block(block_size / 4), // Assuming word size is 4 bytes
-                                                       stats(statistics)
+namespace
+{
+// Stride of a weight-1 core under WeightedFair; a core of weight w advances by this / w
+const uint64_t FAIR_SHARE_STRIDE = 1u << 20;
+}
+
+ArbitrationPolicy parseArbitrationPolicy(const std::string &name)
+{
+    if (name == "rr")
+    {
+        return ArbitrationPolicy::RoundRobin;
+    }
+    if (name == "oldest")
+    {
+        return ArbitrationPolicy::OldestFirst;
+    }
+    if (name == "priority")
+    {
+        return ArbitrationPolicy::FixedPriority;
+    }
+    if (name == "weighted")
+    {
+        return ArbitrationPolicy::WeightedFair;
+    }
+    throw std::invalid_argument("Unknown arbitration policy '" + name + "' (expected rr, oldest, priority or weighted).");
+}
+
+Bus::Bus(unsigned int block_size, Stats *statistics, const LatencyConfig &latency) : requests_per_core(NUM_CORES),
+                                                                                     core_priority_order(NUM_CORES),
+                                                                                     stride(NUM_CORES, FAIR_SHARE_STRIDE),
+                                                                                     pass(NUM_CORES, 0),
+                                                                                     block_size_bytes(block_size),
+                                                                                     words_per_block(std::max(1u, block_size / latency.bus_width_bytes)),
+                                                                                     stats(statistics)
 {
     if (block_size == 0 || (block_size % 4 != 0))
     {
@@ -20,6 +53,52 @@ Bus::Bus(unsigned int block_size, Stats *statistics) : requests_per_core(NUM_COR
     }
     // Initialize priority order (e.g., 0, 1, 2, 3)
     std::iota(core_priority_order.begin(), core_priority_order.end(), 0);
+
+    transaction_latency[static_cast<int>(BusTransaction::BusRd)] = latency.mem_latency;
+    transaction_latency[static_cast<int>(BusTransaction::BusRdX)] = latency.mem_latency;
+    transaction_latency[static_cast<int>(BusTransaction::BusUpgr)] = latency.upgrade_latency;
+    transaction_latency[static_cast<int>(BusTransaction::Writeback)] = latency.writeback_latency;
+    c2c_block_latency = latency.c2c_cycles_per_word * words_per_block; // 2N cycles by default
+    memory = MemoryBackend::create(latency, stats);
+}
+
+void Bus::setArbitration(ArbitrationPolicy policy, const std::vector<int> &order,
+                         const std::vector<unsigned int> &weights, bool demand_over_writeback)
+{
+    if (!order.empty())
+    {
+        std::vector<int> sorted = order;
+        std::sort(sorted.begin(), sorted.end());
+        for (int i = 0; i < NUM_CORES; ++i)
+        {
+            if (sorted.size() != NUM_CORES || sorted[i] != i)
+            {
+                throw std::invalid_argument("Arbitration priority order must list every core exactly once.");
+            }
+        }
+        core_priority_order = order;
+    }
+    if (!weights.empty())
+    {
+        if (weights.size() != NUM_CORES || std::count(weights.begin(), weights.end(), 0u) > 0)
+        {
+            throw std::invalid_argument("Arbitration weights must give every core a weight of at least 1.");
+        }
+        for (int i = 0; i < NUM_CORES; ++i)
+        {
+            stride[i] = FAIR_SHARE_STRIDE / weights[i];
+        }
+    }
+    arbitration_policy = policy;
+    demand_first = demand_over_writeback;
+}
+
+void Bus::setSlice(unsigned int index, unsigned int count, unsigned int block_bits, const std::vector<cycle_t> &traversal)
+{
+    slice_index = index;
+    slice_count = count;
+    slice_block_bits = block_bits;
+    traversal_latency = traversal;
 }
 
 void Bus::registerCache(Cache *cache)
@@ -42,6 +121,76 @@ bool Bus::addRequest(const BusRequest &request)
     return true;
 }
 
+void Bus::saveState(CheckpointWriter &out) const
+{
+    for (const auto &core_queue : requests_per_core)
+    {
+        std::queue<BusRequest> pending = core_queue; // std::queue cannot be iterated, walk a copy
+        out.put<uint64_t>(pending.size());
+        while (!pending.empty())
+        {
+            out.putRequest(pending.front());
+            pending.pop();
+        }
+    }
+    out.putVector(core_priority_order);
+    out.put<int32_t>(arbitration_pointer);
+    out.putVector(pass);
+    out.put(virtual_time);
+    out.put<int32_t>(writeback_drain_pointer);
+    out.put<uint8_t>(busy);
+    out.put(transaction_end_cycle);
+    out.putRequest(current_transaction);
+    out.put<uint8_t>(current_snoop.data_supplied);
+    out.put<uint8_t>(current_snoop.was_dirty);
+    out.put<uint8_t>(current_snoop.is_shared);
+    out.putVector(current_snoop.sharers);
+    out.put<int32_t>(current_winner);
+    out.put(total_bus_transactions);
+    out.put(busy_cycles);
+    out.put<uint8_t>(memory != nullptr);
+    if (memory)
+    {
+        memory->saveState(out);
+    }
+}
+
+void Bus::loadState(CheckpointReader &in)
+{
+    for (auto &core_queue : requests_per_core)
+    {
+        core_queue = std::queue<BusRequest>();
+        uint64_t count = in.get<uint64_t>();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            core_queue.push(in.getRequest());
+        }
+    }
+    core_priority_order = in.getVector<int>();
+    arbitration_pointer = in.get<int32_t>();
+    pass = in.getVector<uint64_t>();
+    virtual_time = in.get<uint64_t>();
+    writeback_drain_pointer = in.get<int32_t>();
+    busy = in.get<uint8_t>() != 0;
+    transaction_end_cycle = in.get<cycle_t>();
+    current_transaction = in.getRequest();
+    current_snoop.data_supplied = in.get<uint8_t>() != 0;
+    current_snoop.was_dirty = in.get<uint8_t>() != 0;
+    current_snoop.is_shared = in.get<uint8_t>() != 0;
+    current_snoop.sharers = in.getVector<int>();
+    current_winner = in.get<int32_t>();
+    total_bus_transactions = in.get<uint64_t>();
+    busy_cycles = in.get<cycle_t>();
+    if (in.get<uint8_t>() != (memory != nullptr))
+    {
+        throw std::runtime_error("Checkpoint was taken with a different memory_model.");
+    }
+    if (memory)
+    {
+        memory->loadState(in);
+    }
+}
+
 void Bus::tick(cycle_t current_cycle)
 {
     // 1. Check if current transaction finishes this cycle
@@ -51,12 +200,13 @@ void Bus::tick(cycle_t current_cycle)
         Cache *ownerCache = caches[current_transaction.requestingCoreId];
 
         // Notify the cache that its request is done (data available/writeback done etc.)
-        ownerCache->Cache::handleBusCompletion(current_transaction, current_cycle);
+        ownerCache->Cache::handleBusCompletion(current_transaction, current_snoop, current_cycle);
 
         // Reset bus state
         busy = false;
         current_winner = -1;
         current_transaction = {}; // Clear current transaction
+        current_snoop = {};
     }
 
     // 2. If bus is not busy, arbitrate and start the next transaction
@@ -65,42 +215,117 @@ void Bus::tick(cycle_t current_cycle)
         if (arbitrate(current_cycle))
         { // Sets current_winner and current_transaction
             // Broadcast snoop messages to OTHERS and check for C2C transfer/sharing
-            SnoopResult snoop_result = processSnooping(current_transaction, current_winner, current_cycle);
+            current_snoop = processSnooping(current_transaction, current_winner, current_cycle);
+            if (event_log)
+            {
+                event_log->record(current_cycle, EventKind::BusGrant, current_winner, current_transaction.address,
+                                  static_cast<uint8_t>(current_transaction.type),
+                                  (current_snoop.data_supplied ? EVENT_DATA_SUPPLIED : 0) | (current_snoop.is_shared ? EVENT_SHARED : 0));
+            }
 
             // Start the transaction (sets bus busy state and timer)
-            startTransaction(current_transaction, snoop_result, current_cycle);
+            startTransaction(current_transaction, current_snoop, current_cycle);
         }
     }
 }
 
-// Round-Robin Arbitration
-bool Bus::arbitrate(cycle_t current_cycle)
+int Bus::selectRequester()
 {
-    int checked_cores = 0;
-    int current_arbitration_index = arbitration_pointer;
+    bool demand_waiting = false;
+    if (demand_first)
+    {
+        for (const auto &core_queue : requests_per_core)
+        {
+            demand_waiting = demand_waiting || (!core_queue.empty() && core_queue.front().type != BusTransaction::Writeback);
+        }
+    }
+    auto ready = [&](int core)
+    {
+        const auto &core_queue = requests_per_core[core];
+        return !core_queue.empty() && !(demand_waiting && core_queue.front().type == BusTransaction::Writeback);
+    };
 
-    while (checked_cores < NUM_CORES)
+    if (arbitration_policy == ArbitrationPolicy::FixedPriority)
     {
-        int core_to_check = core_priority_order[current_arbitration_index];
+        for (int core : core_priority_order)
+        {
+            if (ready(core))
+                return core;
+        }
+        return -1;
+    }
 
-        if (!requests_per_core[core_to_check].empty())
+    // The rest scan from the round-robin pointer, so ties go to the next core in rotation
+    int winner_index = -1;
+    for (int checked = 0; checked < NUM_CORES; ++checked)
+    {
+        int index = (arbitration_pointer + checked) % NUM_CORES;
+        int core = core_priority_order[index];
+        if (!ready(core))
+            continue;
+        if (arbitration_policy == ArbitrationPolicy::RoundRobin)
         {
-            current_winner = core_to_check;
-            current_transaction = requests_per_core[core_to_check].front();
-            requests_per_core[core_to_check].pop();
+            winner_index = index;
+            break;
+        }
+        if (arbitration_policy == ArbitrationPolicy::WeightedFair)
+        {
+            pass[core] = std::max(pass[core], virtual_time); // No credit for time spent idle
+        }
+        if (winner_index == -1)
+        {
+            winner_index = index;
+            continue;
+        }
+        int best = core_priority_order[winner_index];
+        bool better = (arbitration_policy == ArbitrationPolicy::OldestFirst)
+                          ? requests_per_core[core].front().request_cycle < requests_per_core[best].front().request_cycle
+                          : pass[core] < pass[best];
+        if (better)
+            winner_index = index;
+    }
+    if (winner_index == -1)
+        return -1;
 
-            arbitration_pointer = (current_arbitration_index + 1) % NUM_CORES;
+    int winner = core_priority_order[winner_index];
+    arbitration_pointer = (winner_index + 1) % NUM_CORES;
+    if (arbitration_policy == ArbitrationPolicy::WeightedFair)
+    {
+        virtual_time = pass[winner];
+        pass[winner] += stride[winner];
+    }
+    return winner;
+}
 
-            if (current_transaction.request_cycle == 0)
-            {
-                current_transaction.request_cycle = current_cycle;
-            }
+bool Bus::arbitrate(cycle_t current_cycle)
+{
+    L1SIM_PROFILE_ZONE(Arbitration);
+    int winner = selectRequester();
+    if (winner != -1)
+    {
+        current_winner = winner;
+        current_transaction = requests_per_core[winner].front();
+        requests_per_core[winner].pop();
 
-            return true; // Winner found
+        if (current_transaction.request_cycle == 0)
+        {
+            current_transaction.request_cycle = current_cycle;
         }
+        stats->recordBusGrant(winner, current_cycle - current_transaction.request_cycle);
+
+        return true; // Winner found
+    }
 
-        current_arbitration_index = (current_arbitration_index + 1) % NUM_CORES;
-        checked_cores++;
+    // No demand traffic: drain a buffered writeback, if any cache has one
+    for (int i = 0; i < static_cast<int>(caches.size()); ++i)
+    {
+        int cache_index = (writeback_drain_pointer + i) % caches.size();
+        if (caches[cache_index]->popBufferedWriteback(current_transaction, current_cycle, *this))
+        {
+            current_winner = cache_index;
+            writeback_drain_pointer = (cache_index + 1) % caches.size();
+            return true;
+        }
     }
 
     current_winner = -1;
@@ -109,6 +334,7 @@ bool Bus::arbitrate(cycle_t current_cycle)
 
 SnoopResult Bus::processSnooping(const BusRequest &request, int requestingCoreId, cycle_t current_cycle)
 {
+    L1SIM_PROFILE_ZONE(Snooping);
     SnoopResult combined_result;
     int sharer_count = 0;
     int invalidation_count = 0;
@@ -118,49 +344,43 @@ SnoopResult Bus::processSnooping(const BusRequest &request, int requestingCoreId
     {
         if (i == requestingCoreId)
             continue; // Don't snoop self
+        if (!caches[i]->mayHoldBlock(request.address))
+            continue; // Filtered: the block cannot be in this cache
 
-        SnoopResult result = caches[i]->snoopRequest(request.type, request.address, current_cycle);
+        // One tag lookup per cache: is_shared reports whether it still holds a valid copy afterwards
+        SnoopResult result = caches[i]->snoopRequest(request.type, request.address, current_cycle, request.sector_mask);
 
-        if (result.data_supplied)
+        if (result.data_supplied && !combined_result.data_supplied)
         {
-            if (!combined_result.data_supplied)
-            {
-                combined_result = result;
-            }
+            combined_result.data_supplied = true;
+            combined_result.was_dirty = result.was_dirty;
         }
-        if (caches[i]->isBlockShared(request.address))
+        if (result.is_shared)
         {
             sharer_count++;
             combined_result.sharers.push_back(i);
         }
     }
 
-    if (request.type == BusTransaction::BusRd || request.type == BusTransaction::BusRdX || request.type == BusTransaction::BusUpgr)
-    {
-        if (sharer_count > 0)
-        {
-            combined_result.is_shared = true;
-        }
-        if (request.type == BusTransaction::BusRd && sharer_count == 0 && !combined_result.data_supplied)
-        {
-            combined_result.is_shared = false;
-        }
-        else
-        {
-            combined_result.is_shared = true;
-        }
-
-        if (request.type == BusTransaction::BusRdX || request.type == BusTransaction::BusUpgr)
-        {
-            combined_result.is_shared = false;
-        }
-    }
+    // A BusRd fill lands in SHARED if any other cache kept a copy, EXCLUSIVE otherwise.
+    // BusRdX/BusUpgr leave the requester as the only holder.
+    combined_result.is_shared = (request.type == BusTransaction::BusRd && sharer_count > 0);
 
     return combined_result;
 }
 
+uint64_t Bus::transferBytes(const BusRequest &request) const
+{
+    if (sector_size_bytes == 0 || request.sector_mask == 0)
+    {
+        return block_size_bytes;
+    }
+    return static_cast<uint64_t>(std::popcount(request.sector_mask)) * sector_size_bytes;
+}
+
 void Bus::startTransaction(const BusRequest &request, const SnoopResult &snoop_result, cycle_t current_cycle)
 {
+    L1SIM_PROFILE_ZONE(TransactionStart);
     busy = true;
     cycle_t latency = 0;
     uint64_t traffic = 0;
@@ -176,28 +396,31 @@ void Bus::startTransaction(const BusRequest &request, const SnoopResult &snoop_r
     case BusTransaction::BusRd:
     case BusTransaction::BusRdX:
         is_data_transfer = true;
+        traffic = transferBytes(request);
         if (snoop_result.data_supplied)
         {
-            // Cache-to-cache transfer
-            latency = C2C_BLOCK_TRANSFER_CYCLE_FACTOR * words_per_block; // 2N cycles
-            traffic = block_size_bytes;
+            // Cache-to-cache transfer, at least one bus word even for a narrow sector
+            latency = (traffic == block_size_bytes) ? c2c_block_latency
+                                                    : std::max<cycle_t>(c2c_block_latency * traffic / block_size_bytes,
+                                                                        c2c_block_latency / words_per_block);
         }
         else
         {
             // Fetch from memory
-            latency = MEM_ACCESS_CYCLES;
-            traffic = block_size_bytes;
+            latency = memory ? memory->access(request.address, false, current_cycle)
+                             : transaction_latency[static_cast<int>(request.type)];
         }
         break;
 
     case BusTransaction::Writeback:
         is_data_transfer = true;
-        latency = MEM_ACCESS_CYCLES;
-        traffic = block_size_bytes; // Writing block back
+        latency = memory ? memory->access(request.address, true, current_cycle)
+                         : transaction_latency[static_cast<int>(request.type)];
+        traffic = transferBytes(request); // Writing the block (or its dirty sectors) back
         break;
 
     case BusTransaction::BusUpgr:
-        latency = 1;
+        latency = transaction_latency[static_cast<int>(request.type)];
         traffic = 0;
         break;
     case BusTransaction::NoTransaction:
@@ -205,11 +428,20 @@ void Bus::startTransaction(const BusRequest &request, const SnoopResult &snoop_r
         return;
     }
 
+    if (!traversal_latency.empty())
+    {
+        latency += traversal_latency[request.requestingCoreId];
+    }
+    busy_cycles += latency;
     transaction_end_cycle = current_cycle + latency;
 
     // Record data traffic if any
     if (is_data_transfer && traffic > 0)
     {
         stats->addBusTraffic(traffic, request.requestingCoreId);
+        if (traffic < block_size_bytes)
+        {
+            stats->recordSectorBytesSaved(block_size_bytes - traffic);
+        }
     }
 }
\ No newline at end of file
@@ -6,22 +6,46 @@
 #include <memory> 
 #include <numeric> 
 #include "defs.h"
+#include "latency_config.h"
+#include "memory.h"
+#include "event_log.h"
 #include "cache.h"
+#include "arbitration.h"
 class Cache; 
 class Stats;
+class CheckpointWriter;
+class CheckpointReader;
 
 class Bus {
 private:
     // One queue per core to facilitate round-robin
     std::vector<std::queue<BusRequest>> requests_per_core;
-    std::vector<int> core_priority_order; 
+    std::vector<int> core_priority_order; // Scan order; highest priority first for FixedPriority
     int arbitration_pointer = 0; 
+    ArbitrationPolicy arbitration_policy = ArbitrationPolicy::RoundRobin;
+    bool demand_first = false; // Writebacks only win when no core has a demand request waiting
+    // WeightedFair: each grant advances the core's pass by its stride (inversely
+    // proportional to its weight); the lowest pass wins
+    std::vector<uint64_t> stride;
+    std::vector<uint64_t> pass;
+    uint64_t virtual_time = 0; // Pass of the last winner; idle cores catch up to it
+    int writeback_drain_pointer = 0; // Round-robin over caches' writeback buffers
 
     bool busy = false;
     cycle_t transaction_end_cycle = 0;
     BusRequest current_transaction;
+    SnoopResult current_snoop; // Gathered when current_transaction started, delivered at completion
     int current_winner = -1;
 
+    // This bus's place in the interconnect: it carries the blocks whose block number is
+    // slice_index modulo slice_count, and a transaction from core c holds it for an extra
+    // traversal_latency[c] cycles (request and response travel)
+    unsigned int slice_index = 0;
+    unsigned int slice_count = 1;
+    unsigned int slice_block_bits = 0;
+    std::vector<cycle_t> traversal_latency;
+    cycle_t busy_cycles = 0;
+
 
     uint64_t total_bus_transactions = 0;
 
@@ -29,18 +53,45 @@ private:
 
     unsigned int block_size_bytes; 
     unsigned int words_per_block;
+    unsigned int sector_size_bytes = 0; // 0 = unsectored: every data transfer moves a whole block
+    // Bytes a data transaction moves: the sectors in its mask, or the whole block
+    uint64_t transferBytes(const BusRequest& request) const;
     Stats* stats; 
 
+    // Latencies resolved once at construction: memory-served cost per transaction type,
+    // and the cost of a whole-block cache-to-cache transfer
+    cycle_t transaction_latency[static_cast<int>(BusTransaction::Writeback) + 1] = {};
+    cycle_t c2c_block_latency = 0;
+    // Null for the flat memory model, whose costs come straight from transaction_latency
+    std::unique_ptr<MemoryBackend> memory;
+
+    EventLog* event_log = nullptr; // Null unless a replay log was requested
+
     bool arbitrate(cycle_t current_cycle); 
+    // The core whose queued request goes next under the arbitration policy, or -1
+    int selectRequester();
     SnoopResult processSnooping(const BusRequest& request, int requestingCoreId, cycle_t current_cycle); 
     void startTransaction(const BusRequest& request, const SnoopResult& snoop_result, cycle_t current_cycle);
 
     
 
 public:
-    Bus(unsigned int block_size, Stats* statistics);
+    Bus(unsigned int block_size, Stats* statistics, const LatencyConfig& latency = LatencyConfig());
 
     void registerCache(Cache* cache);
+    void setEventLog(EventLog* log) { event_log = log; }
+    // Caches split each block into this many sectors; requests with a sector mask then
+    // move, and pay cache-to-cache transfer time for, only those sectors
+    void setSectors(unsigned int sectors) { sector_size_bytes = sectors > 1 ? block_size_bytes / sectors : 0; }
+    void setSlice(unsigned int index, unsigned int count, unsigned int block_bits, const std::vector<cycle_t>& traversal);
+    bool ownsBlock(addr_t block_addr) const
+    {
+        return slice_count == 1 || (block_addr >> slice_block_bits) % slice_count == slice_index;
+    }
+    // order lists the cores highest priority first (FixedPriority); weights gives each
+    // core's share (WeightedFair). Either may be empty to keep the default.
+    void setArbitration(ArbitrationPolicy policy, const std::vector<int>& order,
+                        const std::vector<unsigned int>& weights, bool demand_over_writeback);
 
     bool addRequest(const BusRequest& request);
 
@@ -49,6 +100,10 @@ public:
     bool isBusy() const { return busy; }
 
     uint64_t getTotalTransactions() const { return total_bus_transactions; } 
+    cycle_t getBusyCycles() const { return busy_cycles; }
+
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
 
 };
 
@@ -1,16 +1,19 @@
 #include "cache.h"
+#include "checkpoint.h"
+#include "profile.h"
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
 
-Cache::Cache(int core_id, unsigned int s, unsigned int E, unsigned int b, Bus *shared_bus, Stats *statistics) : id(core_id),
-                                                                                                                num_sets(s == 0 ? 1 : (1 << s)),
-                                                                                                                associativity(E),
-                                                                                                                block_size(1 << b),
-                                                                                                                block_bits(b),
-                                                                                                                set_bits(s),
-                                                                                                                sets(num_sets, CacheSet(E)),
-                                                                                                                bus(shared_bus),
-                                                                                                                stats(statistics)
+Cache::Cache(int core_id, unsigned int s, unsigned int E, unsigned int b, Interconnect *shared_bus, Stats *statistics) : id(core_id),
+                                                                                                                         num_sets(s == 0 ? 1 : (1 << s)),
+                                                                                                                         associativity(E),
+                                                                                                                         block_size(1 << b),
+                                                                                                                         block_bits(b),
+                                                                                                                         set_bits(s),
+                                                                                                                         sets(num_sets, CacheSet(E)),
+                                                                                                                         bus(shared_bus),
+                                                                                                                         stats(statistics)
 {
     if (bus == nullptr || stats == nullptr)
     {
@@ -21,13 +24,66 @@ Cache::Cache(int core_id, unsigned int s, unsigned int E, unsigned int b, Bus *s
         throw std::invalid_argument("Associativity and Block Size must be non-zero.");
     }
     bus->registerCache(this);
+    selectAccessPath();
+}
+
+template <int SetBits, int BlockBits>
+Cache::AccessPath Cache::selectWays() const
+{
+    switch (associativity)
+    {
+    case 1:
+        return &Cache::accessWith<SetBits, 1, BlockBits>;
+    case 2:
+        return &Cache::accessWith<SetBits, 2, BlockBits>;
+    case 4:
+        return &Cache::accessWith<SetBits, 4, BlockBits>;
+    case 8:
+        return &Cache::accessWith<SetBits, 8, BlockBits>;
+    default:
+        return &Cache::accessWith<SetBits, GEOMETRY_RUNTIME, BlockBits>;
+    }
+}
+
+template <int BlockBits>
+Cache::AccessPath Cache::selectSets() const
+{
+    switch (set_bits)
+    {
+    case 5:
+        return selectWays<5, BlockBits>();
+    case 6:
+        return selectWays<6, BlockBits>();
+    case 7:
+        return selectWays<7, BlockBits>();
+    default:
+        return selectWays<GEOMETRY_RUNTIME, BlockBits>();
+    }
+}
+
+void Cache::selectAccessPath()
+{
+    // Fully constant for 32/64-byte blocks with 32-128 sets; otherwise only the
+    // associativity is fixed (when it is 1, 2, 4 or 8)
+    switch (block_bits)
+    {
+    case 5:
+        access_path = selectSets<5>();
+        break;
+    case 6:
+        access_path = selectSets<6>();
+        break;
+    default:
+        access_path = selectWays<GEOMETRY_RUNTIME, GEOMETRY_RUNTIME>();
+        break;
+    }
 }
 
 addr_t Cache::getTag(addr_t address) const
 {
     if ((set_bits + block_bits) >= 32)
         return 0;
-    return address >> (set_bits + block_bits);
+    return static_cast<uint32_t>(address) >> (set_bits + block_bits);
 }
 
 unsigned int Cache::getIndex(addr_t address) const
@@ -46,48 +102,459 @@ addr_t Cache::getBlockAddress(addr_t address) const
     return address & mask;
 }
 
-addr_t Cache::reconstructAddress(addr_t tag, unsigned int index) const
+addr_t Cache::reconstructAddress(addr_t tag, unsigned int index, asid_t asid) const
 {
-    return (tag << (set_bits + block_bits)) | (index << block_bits);
+    return withAsid((tag << (set_bits + block_bits)) | (index << block_bits), asid);
+}
+
+void Cache::saveState(CheckpointWriter &out) const
+{
+    out.put<uint32_t>(num_sets);
+    out.put<uint32_t>(associativity);
+    for (const CacheSet &set : sets)
+    {
+        for (unsigned int way = 0; way < associativity; ++way)
+        {
+            const CacheLine &line = set.getLine(way);
+            out.put<uint8_t>(static_cast<uint8_t>(line.state));
+            out.put(line.asid);
+            out.put(line.tag);
+            out.put(line.lastUsedCycle);
+        }
+    }
+    for (const CacheSet &set : sets)
+    {
+        out.put<uint32_t>(set.getMruWay());
+    }
+    out.put<uint8_t>(compression != nullptr);
+    if (compression)
+    {
+        for (const CacheSet &set : sets)
+        {
+            for (unsigned int way = 0; way < associativity; ++way)
+            {
+                out.put<uint8_t>(static_cast<uint8_t>(set.getSegments(way)));
+            }
+        }
+    }
+    out.put<uint32_t>(sector_count);
+    for (const SectorBits &sectors : sector_state)
+    {
+        out.put(sectors.valid);
+        out.put(sectors.dirty);
+    }
+
+    out.put<uint64_t>(pending_requests.size());
+    for (const auto &[block_addr, pending] : pending_requests)
+    {
+        out.put(block_addr);
+        out.put<uint8_t>(static_cast<uint8_t>(pending.original_op));
+        out.put<int32_t>(pending.target_way);
+        out.put<uint8_t>(pending.writeback_pending);
+        out.put(pending.victim_addr);
+        out.put(pending.request_init_cycle);
+        out.put(pending.access_sector);
+        out.put<uint8_t>(pending.low_priority);
+    }
+    out.put<uint8_t>(stalled);
+    out.put<uint64_t>(writeback_buffer.size());
+    for (const BusRequest &buffered : writeback_buffer)
+    {
+        out.putRequest(buffered);
+    }
+    out.put<uint8_t>(l2 != nullptr);
+    if (l2)
+    {
+        l2->saveState(out);
+        out.put<uint8_t>(l2_fill_pending);
+        out.put(l2_fill_block);
+        out.put(l2_fill_cycle);
+    }
+    out.put<uint8_t>(victim_cache != nullptr);
+    if (victim_cache)
+    {
+        victim_cache->saveState(out);
+    }
+    out.put<uint8_t>(insertion != nullptr);
+    if (insertion)
+    {
+        insertion->saveState(out);
+        for (uint8_t flag : low_priority_lines)
+        {
+            out.put(flag);
+        }
+    }
+}
+
+void Cache::loadState(CheckpointReader &in)
+{
+    if (in.get<uint32_t>() != num_sets || in.get<uint32_t>() != associativity)
+    {
+        throw std::runtime_error("Checkpoint cache geometry does not match this configuration.");
+    }
+    for (CacheSet &set : sets)
+    {
+        for (unsigned int way = 0; way < associativity; ++way)
+        {
+            CacheLine &line = set.getLine(way);
+            line.state = static_cast<MESIState>(in.get<uint8_t>());
+            line.asid = in.get<asid_t>();
+            line.tag = in.get<uint32_t>();
+            line.lastUsedCycle = in.get<cycle_t>();
+        }
+    }
+    for (CacheSet &set : sets)
+    {
+        set.setMruWay(static_cast<int>(std::min(in.get<uint32_t>(), associativity - 1)));
+    }
+    if (in.get<uint8_t>() != (compression != nullptr))
+    {
+        throw std::runtime_error("Checkpoint was taken with a different compression setting.");
+    }
+    if (compression)
+    {
+        for (CacheSet &set : sets)
+        {
+            for (unsigned int way = 0; way < associativity; ++way)
+            {
+                set.setSegments(way, in.get<uint8_t>());
+            }
+        }
+    }
+    if (in.get<uint32_t>() != sector_count)
+    {
+        throw std::runtime_error("Checkpoint was taken with a different sector count.");
+    }
+    for (SectorBits &sectors : sector_state)
+    {
+        sectors.valid = in.get<uint32_t>();
+        sectors.dirty = in.get<uint32_t>();
+    }
+
+    pending_requests.clear();
+    uint64_t count = in.get<uint64_t>();
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        addr_t block_addr = in.get<addr_t>();
+        PendingRequest pending;
+        pending.original_op = static_cast<Operation>(in.get<uint8_t>());
+        pending.target_way = in.get<int32_t>();
+        pending.writeback_pending = in.get<uint8_t>() != 0;
+        pending.victim_addr = in.get<addr_t>();
+        pending.request_init_cycle = in.get<cycle_t>();
+        pending.access_sector = in.get<uint32_t>();
+        pending.low_priority = in.get<uint8_t>() != 0;
+        pending_requests[block_addr] = pending;
+    }
+    stalled = in.get<uint8_t>() != 0;
+    writeback_buffer.clear();
+    uint64_t buffered_count = in.get<uint64_t>();
+    for (uint64_t i = 0; i < buffered_count; ++i)
+    {
+        writeback_buffer.push_back(in.getRequest());
+    }
+    if (in.get<uint8_t>() != (l2 != nullptr))
+    {
+        throw std::runtime_error("Checkpoint was taken with a different L2 configuration.");
+    }
+    if (l2)
+    {
+        l2->loadState(in);
+        l2_fill_pending = in.get<uint8_t>() != 0;
+        l2_fill_block = in.get<addr_t>();
+        l2_fill_cycle = in.get<cycle_t>();
+    }
+    if (in.get<uint8_t>() != (victim_cache != nullptr))
+    {
+        throw std::runtime_error("Checkpoint was taken with a different victim cache setting.");
+    }
+    if (victim_cache)
+    {
+        victim_cache->loadState(in);
+    }
+    if (in.get<uint8_t>() != (insertion != nullptr))
+    {
+        throw std::runtime_error("Checkpoint was taken with a different insertion policy setting.");
+    }
+    if (insertion)
+    {
+        insertion->loadState(in);
+        for (uint8_t &flag : low_priority_lines)
+        {
+            flag = in.get<uint8_t>();
+        }
+    }
+    rebuildSnoopFilter();
+}
+
+void Cache::setSectors(unsigned int sectors)
+{
+    if (sectors == 0 || sectors > 32 || (sectors & (sectors - 1)) != 0 || sectors > block_size / 4)
+    {
+        throw std::invalid_argument("Sectors per block must be a power of two, at most 32 and at most one per 4-byte word.");
+    }
+    sector_count = sectors;
+    sector_bits = block_bits;
+    while ((1u << (block_bits - sector_bits)) < sectors)
+    {
+        sector_bits--;
+    }
+    sector_state.assign(sectors > 1 ? num_sets * associativity : 0, SectorBits());
+}
+
+void Cache::setCompression(CompressionModel model, unsigned int tags_per_way, cycle_t decompress_latency, uint64_t seed)
+{
+    if (model == CompressionModel::None)
+    {
+        compression.reset();
+        return;
+    }
+    if (tags_per_way == 0)
+    {
+        throw std::invalid_argument("A compressed cache needs at least one tag per way.");
+    }
+    compression = std::make_unique<CompressibilityModel>(model, block_size, seed);
+    decompression_latency = decompress_latency;
+    unsigned int data_ways = associativity;
+    associativity *= tags_per_way;
+    sets.assign(num_sets, CacheSet(associativity));
+    for (CacheSet &set : sets)
+    {
+        set.enableCompression(data_ways * compression->segmentsPerBlock());
+    }
+    if (sector_count > 1)
+    {
+        sector_state.assign(num_sets * associativity, SectorBits());
+    }
+    selectAccessPath();
+}
+
+void Cache::setInsertionPolicy(InsertionPolicy policy)
+{
+    if (policy == InsertionPolicy::LRU)
+    {
+        insertion.reset();
+        low_priority_lines.clear();
+        return;
+    }
+    insertion = std::make_unique<InsertionSelector>(policy, num_sets);
+    low_priority_lines.assign(num_sets * associativity, 0);
+}
+
+void Cache::setWayPrediction(WayPrediction prediction, unsigned int partial_tag_bits, cycle_t mispredict_penalty)
+{
+    if (prediction == WayPrediction::PartialTag && (partial_tag_bits == 0 || partial_tag_bits > 16))
+    {
+        throw std::invalid_argument("Partial tags must be 1 to 16 bits wide.");
+    }
+    way_prediction = prediction;
+    partial_tag_mask = (1u << partial_tag_bits) - 1;
+    way_mispredict_penalty = mispredict_penalty;
+}
+
+void Cache::predictWay(unsigned int index, addr_t tag, int hit_way)
+{
+    const CacheSet &set = sets[index];
+    unsigned int comparisons = 0;
+    unsigned int extra_probes = 0;
+    if (way_prediction == WayPrediction::Mru)
+    {
+        // One comparison if the MRU way hits, otherwise every way gets compared
+        bool correct = (hit_way == set.getMruWay());
+        comparisons = correct ? 1 : associativity;
+        extra_probes = (hit_way != -1 && !correct) ? 1 : 0;
+    }
+    else
+    {
+        // Ways whose partial tag matches are probed in order until the hit; a miss probes
+        // all of them. The rest are ruled out without a full comparison.
+        for (unsigned int way = 0; way < associativity; ++way)
+        {
+            const CacheLine &line = set.getLine(way);
+            if (line.isValid() && ((line.tag ^ tag) & partial_tag_mask) == 0)
+            {
+                comparisons++;
+                if (static_cast<int>(way) == hit_way)
+                {
+                    break;
+                }
+            }
+        }
+        extra_probes = (hit_way != -1) ? comparisons - 1 : 0;
+    }
+    if (hit_way != -1)
+    {
+        stats->recordWayPrediction(id, extra_probes == 0);
+        hit_penalty += extra_probes * way_mispredict_penalty;
+    }
+    stats->recordTagComparisons(id, comparisons, associativity - comparisons);
+}
+
+void Cache::recordLowPriorityReuse(unsigned int index, int way)
+{
+    // Predicted dead but used again: the prediction failed
+    lowPriorityOf(index, way) = 0;
+    stats->recordLowPriorityReuse(id);
+}
+
+uint64_t Cache::residentBlocks() const
+{
+    uint64_t resident = 0;
+    for (const CacheSet &set : sets)
+    {
+        for (unsigned int way = 0; way < associativity; ++way)
+        {
+            resident += set.getLine(way).isValid();
+        }
+    }
+    return resident;
+}
+
+void Cache::setSnoopFilter(SnoopFilterKind kind)
+{
+    if (kind == SnoopFilterKind::None)
+    {
+        snoop_filter.reset();
+        return;
+    }
+    snoop_filter = std::make_unique<SnoopFilter>(kind, num_sets * associativity + (victim_cache ? victim_cache->capacity() : 0));
+    rebuildSnoopFilter();
+}
+
+void Cache::rebuildSnoopFilter()
+{
+    if (!snoop_filter)
+    {
+        return;
+    }
+    snoop_filter->clear();
+    for (unsigned int index = 0; index < num_sets; ++index)
+    {
+        for (unsigned int way = 0; way < associativity; ++way)
+        {
+            const CacheLine &line = sets[index].getLine(way);
+            if (line.isValid())
+            {
+                snoop_filter->insert(reconstructAddress(line.tag, index, line.asid));
+            }
+        }
+    }
+    for (const BusRequest &buffered : writeback_buffer)
+    {
+        snoop_filter->insert(buffered.address);
+    }
+    if (l2)
+    {
+        for (addr_t block_addr : l2->validBlocks())
+        {
+            snoop_filter->insert(block_addr);
+        }
+    }
+    if (victim_cache)
+    {
+        for (addr_t block_addr : victim_cache->validBlocks())
+        {
+            snoop_filter->insert(block_addr);
+        }
+    }
+}
+
+bool Cache::mayHoldBlock(addr_t address)
+{
+    if (!snoop_filter)
+    {
+        return true;
+    }
+    bool may_hold = snoop_filter->mayContain(getBlockAddress(address));
+    stats->recordSnoopFilterLookup(may_hold);
+    return may_hold;
 }
 
 bool Cache::access(addr_t address, Operation op, cycle_t current_cycle)
 {
+    L1SIM_PROFILE_ZONE(CacheAccess);
     if (stalled)
     {
         std::cerr << "Warning: Core " << id << " accessed cache while stalled!" << std::endl;
         return false;
     }
 
-    addr_t block_addr = getBlockAddress(address);
-    unsigned int index = getIndex(block_addr);
-    addr_t tag = getTag(block_addr);
+    hit_penalty = 0;
+    return (this->*access_path)(address, op, current_cycle);
+}
+
+template <int SetBits, int Ways, int BlockBits>
+bool Cache::accessWith(addr_t address, Operation op, cycle_t current_cycle)
+{
+    // Same arithmetic as getBlockAddress/getIndex/getTag (s and b are both below 32)
+    const unsigned int s = (SetBits == GEOMETRY_RUNTIME) ? set_bits : SetBits;
+    const unsigned int b = (BlockBits == GEOMETRY_RUNTIME) ? block_bits : BlockBits;
+    addr_t block_addr = address & ~((addr_t(1) << b) - 1);
+    unsigned int index = (block_addr >> b) & ((1u << s) - 1);
+    addr_t tag = (s + b >= 32) ? 0 : static_cast<uint32_t>(block_addr) >> (s + b);
+    asid_t asid = asidOf(address);
 
     stats->recordAccess(id, op);
 
-    int way_index = sets[index].findLine(tag);
+    int way_index;
+    if constexpr (Ways == GEOMETRY_RUNTIME)
+    {
+        // Wide or odd associativity: try the MRU way before scanning the set
+        way_index = sets[index].findLineMruFirst(tag, asid);
+    }
+    else
+    {
+        way_index = sets[index].template findLineFixed<Ways>(tag, asid);
+    }
+    if (way_prediction != WayPrediction::None)
+    {
+        predictWay(index, tag, way_index);
+    }
 
     if (way_index != -1)
     {
         CacheLine &line = sets[index].getLine(way_index);
         MESIState current_state = line.state;
 
+        if (sector_count > 1 && !(sectorsOf(index, way_index).valid & sectorOf(address)))
+        {
+            // The block is here but this sector is not: fetch it, keeping the coherence state
+            stats->recordMiss(id);
+            stats->recordSectorMiss(id);
+            stalled = true;
+            handleMiss(address, index, tag, op, current_cycle);
+            return false;
+        }
+
         if (op == Operation::READ)
         {
             sets[index].updateLRU(way_index, current_cycle);
+            noteReuse(index, way_index);
+            if (compression && sets[index].getSegments(way_index) < compression->segmentsPerBlock())
+            {
+                hit_penalty += decompression_latency;
+                stats->recordDecompression(id, decompression_latency);
+            }
             return true;
         }
         else
         {
             if (current_state == MESIState::MODIFIED)
             {
+                if (sector_count > 1)
+                    sectorsOf(index, way_index).dirty |= sectorOf(address);
                 sets[index].updateLRU(way_index, current_cycle);
+                noteReuse(index, way_index);
                 return true;
             }
             else if (current_state == MESIState::EXCLUSIVE)
             {
+                if (sector_count > 1)
+                    sectorsOf(index, way_index).dirty |= sectorOf(address);
                 line.state = MESIState::MODIFIED;
+                logEvent(EventKind::Upgrade, block_addr, current_state, line.state, current_cycle);
                 sets[index].updateLRU(way_index, current_cycle);
+                noteReuse(index, way_index);
                 return true;
             }
             else
@@ -102,6 +569,10 @@ bool Cache::access(addr_t address, Operation op, cycle_t current_cycle)
     else
     {
         stats->recordMiss(id);
+        if (victim_cache && swapFromVictimCache(block_addr, index, tag, op, current_cycle))
+        {
+            return true;
+        }
         stalled = true;
         handleMiss(address, index, tag, op, current_cycle);
         return false;
@@ -117,20 +588,30 @@ void Cache::handleMiss(addr_t address, unsigned int index, addr_t tag, Operation
         return;
     }
 
-    int existing_way = sets[index].findLine(tag);
-    if (op == Operation::WRITE && existing_way != -1 && sets[index].getLine(existing_way).state == MESIState::SHARED)
+    uint32_t sector = sectorOf(address);
+    int existing_way = sets[index].findLine(tag, asidOf(block_addr));
+    if (existing_way != -1)
     {
+        // A write to a SHARED copy needs ownership; on a sectored cache the block may also
+        // be present without the sector this access touches. A write fetching a sector
+        // always asks for ownership, since a snoop may take the line's state away before
+        // the fill is granted.
+        bool sector_missing = sector_count > 1 && !(sectorsOf(index, existing_way).valid & sector);
+        noteReuse(index, existing_way);
         PendingRequest pending;
         pending.original_op = op;
         pending.target_way = existing_way;
         pending.request_init_cycle = current_cycle;
+        pending.access_sector = sector;
         pending_requests[block_addr] = pending;
-        BusRequest bus_req;
-        bus_req.requestingCoreId = id;
-        bus_req.type = BusTransaction::BusUpgr;
-        bus_req.address = block_addr;
-        bus_req.request_cycle = current_cycle;
-        bus->addRequest(bus_req);
+        if (!sector_missing)
+        {
+            issueBusRequest(BusTransaction::BusUpgr, block_addr, current_cycle);
+        }
+        else
+        {
+            issueBusRequest(op == Operation::WRITE ? BusTransaction::BusRdX : BusTransaction::BusRd, block_addr, current_cycle, sector);
+        }
         return;
     }
 
@@ -148,41 +629,414 @@ void Cache::handleMiss(addr_t address, unsigned int index, addr_t tag, Operation
     pending.original_op = op;
     pending.target_way = target_way;
     pending.request_init_cycle = current_cycle;
+    pending.access_sector = sector;
+    if (insertion)
+    {
+        pending.low_priority = insertion->insertAtLru(index);
+        stats->recordInsertion(id, pending.low_priority);
+    }
     pending_requests[block_addr] = pending;
 
+    if (l2)
+    {
+        CacheLine *l2_line = l2->find(block_addr);
+        stats->recordL2Access(id, l2_line != nullptr);
+        if (l2_line && (op == Operation::READ || l2_line->state != MESIState::SHARED))
+        {
+            // Served by the L2 after its hit latency, without the bus
+            l2_fill_pending = true;
+            l2_fill_block = block_addr;
+            l2_fill_cycle = current_cycle + l2_hit_latency;
+            return;
+        }
+        if (l2_line)
+        {
+            // The data is in the L2 but ownership still has to be obtained
+            issueBusRequest(BusTransaction::BusUpgr, block_addr, current_cycle);
+            return;
+        }
+    }
+
+    issueBusRequest((op == Operation::READ) ? BusTransaction::BusRd : BusTransaction::BusRdX, block_addr, current_cycle, sector);
+}
+
+void Cache::issueBusRequest(BusTransaction type, addr_t block_addr, cycle_t current_cycle, uint32_t sector_mask)
+{
     BusRequest bus_req;
     bus_req.requestingCoreId = id;
-    bus_req.type = (op == Operation::READ) ? BusTransaction::BusRd : BusTransaction::BusRdX;
+    bus_req.type = type;
     bus_req.address = block_addr;
     bus_req.request_cycle = current_cycle;
+    bus_req.sector_mask = sector_mask;
     bus->addRequest(bus_req);
 }
 
-void Cache::allocateBlock(addr_t block_addr, unsigned int index, addr_t tag, int &way_index, cycle_t current_cycle)
+void Cache::setL2(std::unique_ptr<L2Cache> l2_cache, bool inclusive, cycle_t hit_latency)
+{
+    l2 = std::move(l2_cache);
+    l2_inclusive = inclusive;
+    l2_hit_latency = hit_latency;
+}
+
+void Cache::completeL2Fill(cycle_t current_cycle)
+{
+    l2_fill_pending = false;
+    auto pending_it = pending_requests.find(l2_fill_block);
+    if (pending_it == pending_requests.end())
+    {
+        stalled = false;
+        return;
+    }
+    PendingRequest &pending = pending_it->second;
+    bool is_write = (pending.original_op == Operation::WRITE);
+
+    CacheLine *l2_line = l2->find(l2_fill_block);
+    if (!l2_line || (is_write && l2_line->state == MESIState::SHARED))
+    {
+        // A snoop took the L2 copy (or downgraded it) while the fill was in flight
+        BusTransaction type = l2_line ? BusTransaction::BusUpgr : (is_write ? BusTransaction::BusRdX : BusTransaction::BusRd);
+        issueBusRequest(type, l2_fill_block, current_cycle);
+        return;
+    }
+
+    CacheLine &line = sets[getIndex(l2_fill_block)].getLine(pending.target_way);
+    MESIState state_before = line.state;
+    line.state = is_write ? MESIState::MODIFIED : l2_line->state;
+    line.lastUsedCycle = pending.low_priority ? 0 : current_cycle;
+    if (!pending.low_priority)
+    {
+        sets[getIndex(l2_fill_block)].setMruWay(pending.target_way);
+    }
+    if (insertion)
+    {
+        lowPriorityOf(getIndex(l2_fill_block), pending.target_way) = pending.low_priority;
+    }
+    l2->touch(*l2_line, current_cycle);
+    filterInsert(l2_fill_block);
+    logEvent(EventKind::Fill, l2_fill_block, state_before, line.state, current_cycle);
+
+    stats->recordMissService(id, current_cycle - pending.request_init_cycle);
+    pending_requests.erase(pending_it);
+    stalled = false;
+}
+
+void Cache::updateL2(addr_t block_addr, MESIState state, bool install, cycle_t current_cycle)
+{
+    CacheLine *l2_line = l2->find(block_addr);
+    if (l2_line)
+    {
+        l2_line->state = state;
+        l2->touch(*l2_line, current_cycle);
+        return;
+    }
+    if (!install)
+    {
+        return;
+    }
+    L2Cache::Victim victim = l2->install(block_addr, state, current_cycle);
+    filterInsert(block_addr);
+    if (victim.valid)
+    {
+        evictFromL2(victim, current_cycle);
+    }
+}
+
+void Cache::evictFromL2(const L2Cache::Victim &victim, cycle_t current_cycle)
 {
-    way_index = sets[index].findInvalidLine();
+    filterRemove(victim.block_addr);
+    unsigned int index = getIndex(victim.block_addr);
+    int way = sets[index].findLine(getTag(victim.block_addr), asidOf(victim.block_addr));
+    bool dirty = (victim.state == MESIState::MODIFIED);
 
-    if (way_index == -1)
+    if (way != -1)
     {
-        way_index = sets[index].getLRUVictim();
-        CacheLine &victim_line = sets[index].getLine(way_index);
+        CacheLine &line = sets[index].getLine(way);
+        if (l2_inclusive)
+        {
+            // Inclusion: the L1 copy has to go too
+            dirty = dirty || line.state == MESIState::MODIFIED;
+            logEvent(EventKind::Eviction, victim.block_addr, line.state, MESIState::INVALID, current_cycle);
+            line.state = MESIState::INVALID;
+            filterRemove(victim.block_addr);
+            stats->recordL2BackInvalidation(id);
+        }
+        else
+        {
+            // The L1 copy stays and takes over the dirty data
+            if (dirty)
+            {
+                line.state = MESIState::MODIFIED;
+            }
+            dirty = false;
+        }
+    }
+    if (dirty)
+    {
+        initiateWriteback(victim.block_addr, index, way, current_cycle);
+    }
+}
 
-        if (victim_line.isValid())
+void Cache::snoopL2(BusTransaction transaction, addr_t block_addr, bool l1_had_copy, SnoopResult &result, cycle_t current_cycle)
+{
+    CacheLine *line = l2->find(block_addr);
+    if (!line)
+    {
+        return;
+    }
+    MESIState state_before = line->state;
+    bool supplied = false;
+
+    switch (transaction)
+    {
+    case BusTransaction::BusRd:
+        if (state_before == MESIState::MODIFIED || state_before == MESIState::EXCLUSIVE)
         {
-            stats->recordEviction(id);
+            // Dirty data is flushed once, by whichever level had it first
+            if (state_before == MESIState::MODIFIED && !result.was_dirty)
+            {
+                initiateWriteback(block_addr, getIndex(block_addr), -1, current_cycle);
+                result.was_dirty = true;
+            }
+            supplied = true;
+            line->state = MESIState::SHARED;
+        }
+        break;
 
-            if (victim_line.state == MESIState::MODIFIED)
+    case BusTransaction::BusRdX:
+        if (state_before == MESIState::MODIFIED)
+        {
+            if (!result.was_dirty)
             {
-                addr_t victim_addr = reconstructAddress(victim_line.tag, index);
-                initiateWriteback(victim_addr, index, way_index, current_cycle);
+                initiateWriteback(block_addr, getIndex(block_addr), -1, current_cycle);
+                result.was_dirty = true;
             }
+            supplied = true;
+        }
+        line->state = MESIState::INVALID;
+        if (!l1_had_copy)
+        {
+            stats->recordInvalidationReceived(id);
+        }
+        break;
+
+    case BusTransaction::BusUpgr:
+        if (state_before == MESIState::SHARED)
+        {
+            line->state = MESIState::INVALID;
+            if (!l1_had_copy)
+            {
+                stats->recordInvalidationReceived(id);
+            }
+        }
+        break;
+
+    case BusTransaction::Writeback:
+    case BusTransaction::NoTransaction:
+        break;
+    }
+
+    result.data_supplied = result.data_supplied || supplied;
+    if (!line->isValid())
+    {
+        filterRemove(block_addr);
+    }
+    else
+    {
+        result.is_shared = true;
+    }
+    if (line->state != state_before || supplied)
+    {
+        logEvent(EventKind::Snoop, block_addr, state_before, line->state, current_cycle, supplied ? EVENT_DATA_SUPPLIED : 0);
+    }
+}
+
+void Cache::setVictimCache(unsigned int entries, cycle_t hit_latency)
+{
+    victim_cache = entries > 0 ? std::make_unique<VictimCache>(entries) : nullptr;
+    victim_hit_latency = hit_latency;
+}
+
+bool Cache::swapFromVictimCache(addr_t block_addr, unsigned int index, addr_t tag, Operation op, cycle_t current_cycle)
+{
+    VictimCache::Entry *entry = victim_cache->find(block_addr);
+    stats->recordVictimCacheLookup(id, entry != nullptr);
+    if (!entry)
+    {
+        return false;
+    }
+
+    // Freeing the entry first leaves room for the L1 victim, so the swap displaces nothing
+    MESIState state = entry->state;
+    entry->state = MESIState::INVALID;
+    filterRemove(block_addr);
+
+    int way_index = -1;
+    allocateBlock(block_addr, index, tag, way_index, current_cycle);
+    CacheLine &line = sets[index].getLine(way_index);
+    sets[index].setMruWay(way_index);
+    bool needs_ownership = (op == Operation::WRITE && state == MESIState::SHARED);
+    line.state = (op == Operation::WRITE && !needs_ownership) ? MESIState::MODIFIED : state;
+    filterInsert(block_addr);
+    logEvent(EventKind::Fill, block_addr, MESIState::INVALID, line.state, current_cycle);
+    if (needs_ownership)
+    {
+        return false;
+    }
+
+    // The fill stays off the bus, and so does the writeback a dirty victim would have needed
+    stats->recordVictimCacheBusSaved(id, state == MESIState::MODIFIED ? 2 : 1);
+    stats->recordMissService(id, victim_hit_latency);
+    hit_penalty += victim_hit_latency;
+    return true;
+}
+
+void Cache::snoopVictimCache(BusTransaction transaction, addr_t block_addr, SnoopResult &result, cycle_t current_cycle)
+{
+    VictimCache::Entry &entry = *victim_cache->find(block_addr);
+    MESIState state_before = entry.state;
+
+    switch (transaction)
+    {
+    case BusTransaction::BusRd:
+        if (state_before == MESIState::MODIFIED)
+        {
+            initiateWriteback(block_addr, getIndex(block_addr), -1, current_cycle);
+            result.was_dirty = true;
+        }
+        if (state_before == MESIState::MODIFIED || state_before == MESIState::EXCLUSIVE)
+        {
+            entry.state = MESIState::SHARED;
+            result.data_supplied = true;
+        }
+        break;
+
+    case BusTransaction::BusRdX:
+        if (state_before == MESIState::MODIFIED)
+        {
+            initiateWriteback(block_addr, getIndex(block_addr), -1, current_cycle);
+            result.was_dirty = true;
+            result.data_supplied = true;
+        }
+        entry.state = MESIState::INVALID;
+        stats->recordInvalidationReceived(id);
+        break;
+
+    case BusTransaction::BusUpgr:
+        if (state_before == MESIState::SHARED)
+        {
+            entry.state = MESIState::INVALID;
+            stats->recordInvalidationReceived(id);
+        }
+        break;
+
+    case BusTransaction::Writeback:
+    case BusTransaction::NoTransaction:
+        break;
+    }
+
+    if (!entry.isValid())
+    {
+        filterRemove(block_addr);
+    }
+    else
+    {
+        result.is_shared = true;
+    }
+    if (entry.state != state_before || result.data_supplied)
+    {
+        logEvent(EventKind::Snoop, block_addr, state_before, entry.state, current_cycle,
+                 result.data_supplied ? EVENT_DATA_SUPPLIED : 0);
+    }
+}
+
+void Cache::allocateBlock(addr_t block_addr, unsigned int index, addr_t tag, int &way_index, cycle_t current_cycle)
+{
+    if (compression)
+    {
+        // Evict in LRU order until there is a free tag and room in the data array
+        unsigned int needed = compression->segmentsFor(block_addr);
+        while (!sets[index].fits(needed))
+        {
+            evictLine(index, sets[index].getLRUVictim(), current_cycle);
+        }
+        way_index = sets[index].findInvalidLine();
+        sets[index].setSegments(way_index, needed);
+        stats->recordCompressedFill(block_size, needed * (block_size / compression->segmentsPerBlock()));
+    }
+    else
+    {
+        way_index = sets[index].findInvalidLine();
+        if (way_index == -1)
+        {
+            way_index = sets[index].getLRUVictim();
+            evictLine(index, way_index, current_cycle);
         }
     }
 
     CacheLine &target_line = sets[index].getLine(way_index);
     target_line.state = MESIState::INVALID;
-    target_line.tag = tag;
+    if (sector_count > 1)
+    {
+        sectorsOf(index, way_index) = SectorBits();
+    }
+    target_line.asid = asidOf(block_addr);
+    target_line.tag = static_cast<uint32_t>(tag);
     target_line.lastUsedCycle = current_cycle;
+    if (insertion)
+    {
+        lowPriorityOf(index, way_index) = 0;
+    }
+}
+
+void Cache::evictLine(unsigned int index, int way_index, cycle_t current_cycle)
+{
+    CacheLine &victim_line = sets[index].getLine(way_index);
+    if (!victim_line.isValid())
+    {
+        return;
+    }
+
+    stats->recordEviction(id);
+    if (insertion && lowPriorityOf(index, way_index))
+    {
+        // Predicted dead and never reused: the prediction held
+        lowPriorityOf(index, way_index) = 0;
+        stats->recordDeadEviction(id);
+    }
+    addr_t victim_addr = reconstructAddress(victim_line.tag, index, victim_line.asid);
+    logEvent(EventKind::Eviction, victim_addr, victim_line.state, MESIState::INVALID, current_cycle);
+
+    CacheLine *l2_copy = l2 ? l2->find(victim_addr) : nullptr;
+    if (l2_copy)
+    {
+        // Dirty data moves down into the L2 instead of onto the bus
+        if (victim_line.state == MESIState::MODIFIED)
+        {
+            l2_copy->state = MESIState::MODIFIED;
+        }
+    }
+    else if (victim_cache)
+    {
+        // Clean or dirty, the line waits in the victim cache; only a displaced dirty entry
+        // is written back
+        VictimCache::Entry displaced = victim_cache->insert(victim_addr, victim_line.state, current_cycle);
+        filterInsert(victim_addr);
+        if (displaced.isValid())
+        {
+            logEvent(EventKind::Eviction, displaced.block_addr, displaced.state, MESIState::INVALID, current_cycle);
+            filterRemove(displaced.block_addr);
+            if (displaced.state == MESIState::MODIFIED)
+            {
+                initiateWriteback(displaced.block_addr, getIndex(displaced.block_addr), -1, current_cycle);
+            }
+        }
+    }
+    else if (victim_line.state == MESIState::MODIFIED)
+    {
+        initiateWriteback(victim_addr, index, way_index, current_cycle);
+    }
+    filterRemove(victim_addr);
+    victim_line.state = MESIState::INVALID;
 }
 
 void Cache::initiateWriteback(addr_t victim_address, unsigned int victim_set_index, int victim_way_index, cycle_t current_cycle)
@@ -194,47 +1048,84 @@ void Cache::initiateWriteback(addr_t victim_address, unsigned int victim_set_ind
     wb_req.type = BusTransaction::Writeback;
     wb_req.address = victim_address;
     wb_req.request_cycle = current_cycle;
+    if (sector_count > 1)
+    {
+        // Only the dirty sectors go back; the rest of memory's copy is already current
+        SectorBits &sectors = sectorsOf(victim_set_index, victim_way_index);
+        wb_req.sector_mask = sectors.dirty ? sectors.dirty : sectors.valid;
+        sectors.dirty = 0;
+    }
+
+    if (writeback_buffer_capacity > 0)
+    {
+        if (writeback_buffer.size() >= writeback_buffer_capacity)
+        {
+            // Buffer full: push the oldest entry onto the bus ahead of whatever comes next
+            stats->recordWritebackBufferFull(id);
+            BusRequest forced = writeback_buffer.front();
+            forced.request_cycle = current_cycle;
+            filterRemove(forced.address);
+            writeback_buffer.pop_front();
+            bus->addRequest(forced);
+        }
+        writeback_buffer.push_back(wb_req);
+        filterInsert(victim_address);
+        return;
+    }
+
     bus->addRequest(wb_req);
 }
 
-SnoopResult Cache::snoopRequest(BusTransaction transaction, addr_t address, cycle_t current_cycle)
+SnoopResult Cache::snoopRequest(BusTransaction transaction, addr_t address, cycle_t current_cycle, uint32_t sector_mask)
 {
     SnoopResult result;
     addr_t block_addr = getBlockAddress(address);
     unsigned int index = getIndex(block_addr);
     addr_t tag = getTag(block_addr);
 
-    int way_index = sets[index].findLine(tag);
+    int way_index = -1;
+    if (l2 && l2_inclusive && !l2->find(block_addr))
+    {
+        // Inclusive L2 misses, so the L1 cannot hold the block either
+        stats->recordL2SnoopFiltered(id);
+    }
+    else
+    {
+        way_index = sets[index].findLine(tag, asidOf(block_addr));
+    }
 
     if (way_index != -1)
     {
         CacheLine &line = sets[index].getLine(way_index);
         MESIState current_state = line.state;
+        // A sectored copy can only supply the data if it holds every sector asked for
+        bool holds_sectors = sector_count == 1 || sector_mask == 0 ||
+                             (sectorsOf(index, way_index).valid & sector_mask) == sector_mask;
 
         switch (transaction)
         {
         case BusTransaction::BusRd:
             if (current_state == MESIState::MODIFIED)
             {
-                addr_t my_block_addr = reconstructAddress(line.tag, index);
+                addr_t my_block_addr = reconstructAddress(line.tag, index, line.asid);
                 initiateWriteback(my_block_addr, index, way_index, current_cycle);
                 line.state = MESIState::SHARED;
-                result.data_supplied = true;
+                result.data_supplied = holds_sectors;
                 result.was_dirty = true;
             }
             else if (current_state == MESIState::EXCLUSIVE)
             {
                 line.state = MESIState::SHARED;
-                result.data_supplied = true;
+                result.data_supplied = holds_sectors;
             }
             break;
 
         case BusTransaction::BusRdX:
             if (current_state == MESIState::MODIFIED)
             {
-                addr_t my_block_addr = reconstructAddress(line.tag, index);
+                addr_t my_block_addr = reconstructAddress(line.tag, index, line.asid);
                 initiateWriteback(my_block_addr, index, way_index, current_cycle);
-                result.data_supplied = true;
+                result.data_supplied = holds_sectors;
                 result.was_dirty = true;
                 line.state = MESIState::INVALID;
                 stats->recordInvalidationReceived(id);
@@ -266,31 +1157,105 @@ SnoopResult Cache::snoopRequest(BusTransaction transaction, addr_t address, cycl
         case BusTransaction::NoTransaction:
             break;
         }
+        if (!line.isValid())
+        {
+            filterRemove(block_addr);
+            if (sector_count > 1)
+            {
+                sectorsOf(index, way_index) = SectorBits();
+            }
+        }
+        if (line.state != current_state || result.data_supplied)
+        {
+            logEvent(EventKind::Snoop, block_addr, current_state, line.state, current_cycle,
+                     result.data_supplied ? EVENT_DATA_SUPPLIED : 0);
+        }
+    }
+    else if (victim_cache && victim_cache->find(block_addr))
+    {
+        snoopVictimCache(transaction, block_addr, result, current_cycle);
+    }
+    else if (!writeback_buffer.empty() &&
+             (transaction == BusTransaction::BusRd || transaction == BusTransaction::BusRdX) &&
+             findBufferedWriteback(block_addr) != writeback_buffer.end())
+    {
+        // Dirty victim still waiting to drain: the buffer supplies the data if it holds the
+        // sectors asked for. On BusRdX the requester takes ownership of the dirty copy, so
+        // the queued writeback is dropped once nothing dirty is left behind in it.
+        auto buffered = findBufferedWriteback(block_addr);
+        uint32_t buffered_mask = buffered->sector_mask;
+        if (buffered_mask == 0 || (buffered_mask & sector_mask) == sector_mask)
+        {
+            result.data_supplied = true;
+            result.was_dirty = true;
+            stats->recordWritebackBufferSnoopHit(id);
+            logEvent(EventKind::Snoop, block_addr, MESIState::INVALID, MESIState::INVALID, current_cycle, EVENT_DATA_SUPPLIED);
+        }
+        if (transaction == BusTransaction::BusRdX)
+        {
+            if (sector_mask == 0 || (buffered_mask & ~sector_mask) == 0)
+            {
+                writeback_buffer.erase(buffered);
+                filterRemove(block_addr);
+            }
+            else
+            {
+                buffered->sector_mask &= ~sector_mask;
+            }
+        }
+    }
+    else if (snoop_filter && !inWritebackBuffer(block_addr) && !(l2 && l2->find(block_addr)))
+    {
+        // The filter let this snoop through but the block is nowhere in this cache
+        stats->recordSnoopFilterFalsePositive();
     }
 
     if (way_index != -1 && sets[index].getLine(way_index).isValid())
     {
         result.is_shared = true;
     }
+    if (l2)
+    {
+        snoopL2(transaction, block_addr, way_index != -1, result, current_cycle);
+    }
 
     return result;
 }
 
-bool Cache::isBlockShared(addr_t address)
+std::deque<BusRequest>::iterator Cache::findBufferedWriteback(addr_t block_addr)
 {
-    addr_t block_addr = getBlockAddress(address);
-    unsigned int index = getIndex(block_addr);
-    addr_t tag = getTag(block_addr);
+    return std::find_if(writeback_buffer.begin(), writeback_buffer.end(),
+                        [block_addr](const BusRequest &buffered) { return buffered.address == block_addr; });
+}
 
-    int way_index = sets[index].findLine(tag);
-    if (way_index != -1)
+bool Cache::inWritebackBuffer(addr_t block_addr) const
+{
+    for (const BusRequest &buffered : writeback_buffer)
     {
-        return sets[index].getLine(way_index).isValid();
+        if (buffered.address == block_addr)
+        {
+            return true;
+        }
     }
     return false;
 }
 
-void Cache::handleBusCompletion(const BusRequest &completed_request, cycle_t current_cycle)
+bool Cache::popBufferedWriteback(BusRequest &request, cycle_t current_cycle, const Bus &slice)
+{
+    auto it = std::find_if(writeback_buffer.begin(), writeback_buffer.end(),
+                           [&](const BusRequest &buffered) { return slice.ownsBlock(buffered.address); });
+    if (it == writeback_buffer.end())
+    {
+        return false;
+    }
+    request = *it;
+    request.request_cycle = current_cycle;
+    filterRemove(request.address);
+    writeback_buffer.erase(it);
+    return true;
+}
+
+void Cache::handleBusCompletion(const BusRequest &completed_request, const SnoopResult &snoop_result, cycle_t current_cycle)
 {
     if (completed_request.type == BusTransaction::Writeback)
     {
@@ -318,12 +1283,18 @@ void Cache::handleBusCompletion(const BusRequest &completed_request, cycle_t cur
     }
 
     CacheLine &line = sets[index].getLine(way_index);
+    bool was_valid = line.isValid();
+    MESIState state_before = line.state;
 
-    bool shared_after_snoop = false;
     switch (completed_request.type)
     {
     case BusTransaction::BusRd:
-        if (shared_after_snoop)
+        if (was_valid)
+        {
+            // Sector fill into a block this cache already holds: its coherence state stands
+            break;
+        }
+        if (snoop_result.is_shared)
         {
             line.state = MESIState::SHARED;
         }
@@ -341,8 +1312,48 @@ void Cache::handleBusCompletion(const BusRequest &completed_request, cycle_t cur
     default:
         break;
     }
+    if (pending.original_op == Operation::WRITE)
+    {
+        // The write this fill was for completes now, whatever the line held before
+        line.state = MESIState::MODIFIED;
+    }
 
-    line.lastUsedCycle = current_cycle;
+    if (sector_count > 1)
+    {
+        SectorBits &sectors = sectorsOf(index, way_index);
+        if (!was_valid)
+        {
+            sectors = SectorBits();
+        }
+        // An upgrade carries no data, so it only vouches for the sector being written
+        sectors.valid |= completed_request.sector_mask ? completed_request.sector_mask : pending.access_sector;
+        if (pending.original_op == Operation::WRITE)
+        {
+            sectors.dirty |= pending.access_sector;
+        }
+    }
+    if (!was_valid && line.isValid())
+    {
+        filterInsert(block_addr);
+    }
+    logEvent(EventKind::Fill, block_addr, state_before, line.state, current_cycle);
+    if (l2)
+    {
+        // An inclusive L2 must hold everything the L1 does; otherwise upgrades don't allocate
+        updateL2(block_addr, line.state, l2_inclusive || completed_request.type != BusTransaction::BusUpgr, current_cycle);
+    }
+    stats->recordMissService(id, current_cycle - pending.request_init_cycle);
+
+    // A block predicted dead enters at the LRU position, so it is the next victim unless reused
+    line.lastUsedCycle = pending.low_priority ? 0 : current_cycle;
+    if (!pending.low_priority)
+    {
+        sets[index].setMruWay(way_index);
+    }
+    if (insertion && pending.low_priority)
+    {
+        lowPriorityOf(index, way_index) = 1;
+    }
     pending_requests.erase(pending_it);
     stalled = false;
 }
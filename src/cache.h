@@ -4,14 +4,29 @@
 #include <vector>
 #include <cmath> 
 #include <map>  
+#include <deque>
 
 #include "defs.h"
 #include "cache_set.h"
 #include "bus.h"
 #include "stats.h"
+#include "snoop_filter.h"
+#include "event_log.h"
+#include "l2_cache.h"
+#include "interconnect.h"
+#include "compression.h"
+#include "victim_cache.h"
+#include "insertion_policy.h"
+#include "way_prediction.h"
 
 class Bus;
 class Stats;
+class CheckpointWriter;
+class CheckpointReader;
+
+// Template argument meaning "read this geometry field at runtime" (see Cache::accessWith)
+const int GEOMETRY_RUNTIME = -1;
+
 class Cache {
 private:
     int id; // Core ID
@@ -22,14 +37,14 @@ private:
     unsigned int set_bits;   // s
 
     std::vector<CacheSet> sets;
-    Bus* bus; // Pointer to the shared bus
+    Interconnect* bus; // The shared bus, possibly split into address-interleaved slices
     Stats* stats; // Pointer to statistics collector
 
     // Helper methods
     addr_t getTag(addr_t address) const;
     unsigned int getIndex(addr_t address) const;
     addr_t getBlockAddress(addr_t address) const;
-    addr_t reconstructAddress(addr_t tag, unsigned int index) const;
+    addr_t reconstructAddress(addr_t tag, unsigned int index, asid_t asid) const;
 
     // For handling pending misses
     // Using a map to potentially handle multiple outstanding misses later (MSHR idea)
@@ -40,38 +55,191 @@ private:
         bool writeback_pending = false; 
         addr_t victim_addr = 0;     
         cycle_t request_init_cycle = 0; 
+        uint32_t access_sector = 0; // Sector the access touches (sectored caches only)
+        bool low_priority = false;  // The fill goes to the LRU position (insertion policy)
     };
     std::map<addr_t, PendingRequest> pending_requests; // Tracks block addresses waiting for bus data
 
     bool stalled = false; 
 
+    // Optional writeback buffer: dirty victims wait here instead of queueing a Writeback
+    // ahead of the demand miss, and the bus drains them when it is otherwise idle
+    size_t writeback_buffer_capacity = 0; // 0 = disabled
+    std::deque<BusRequest> writeback_buffer; // Queued Writeback requests, oldest first
+    std::deque<BusRequest>::iterator findBufferedWriteback(addr_t block_addr);
+    bool inWritebackBuffer(addr_t block_addr) const;
+
+    // Optional sectoring: each block is split into sector_count sectors with their own
+    // valid and dirty bits, kept beside the lines so CacheLine stays 16 bytes. A miss
+    // fetches only the sector it touches and a writeback carries only dirty sectors;
+    // coherence states stay per block.
+    struct SectorBits {
+        uint32_t valid = 0;
+        uint32_t dirty = 0;
+    };
+    unsigned int sector_count = 1; // 1 = unsectored
+    unsigned int sector_bits = 0;  // log2 of the sector size in bytes
+    std::vector<SectorBits> sector_state; // [set * associativity + way]
+    SectorBits &sectorsOf(unsigned int index, int way) { return sector_state[index * associativity + way]; }
+    uint32_t sectorOf(addr_t address) const
+    {
+        return sector_count > 1 ? 1u << ((address >> sector_bits) & (sector_count - 1)) : 0;
+    }
+
+    // Optional compression: each set has extra tags sharing the data array of an
+    // uncompressed set, and lines take as many segments as their block compresses to.
+    // A read hit on a compressed line costs decompression_latency extra cycles.
+    std::unique_ptr<CompressibilityModel> compression;
+    cycle_t decompression_latency = 0;
+    cycle_t hit_penalty = 0; // Extra cycles charged to the last hit
+
+    // Optional insertion policy: fills predicted dead enter at the LRU position. A line's
+    // flag stays set until it is reused or evicted, which tells whether the prediction held.
+    std::unique_ptr<InsertionSelector> insertion;
+    std::vector<uint8_t> low_priority_lines; // [set * associativity + way]
+    uint8_t &lowPriorityOf(unsigned int index, int way) { return low_priority_lines[index * associativity + way]; }
+    void noteReuse(unsigned int index, int way)
+    {
+        if (insertion && lowPriorityOf(index, way))
+            recordLowPriorityReuse(index, way);
+    }
+    void recordLowPriorityReuse(unsigned int index, int way);
+
+    // Optional way prediction. It changes only hit timing and statistics: which line an
+    // access finds does not depend on it.
+    WayPrediction way_prediction = WayPrediction::None;
+    uint32_t partial_tag_mask = 0;
+    cycle_t way_mispredict_penalty = 0;
+    // Counts the tag comparisons the predictor needed to find hit_way (-1 for a miss) and
+    // charges each extra probe before a hit to hit_penalty
+    void predictWay(unsigned int index, addr_t tag, int hit_way);
+
+    // Optional filter over the blocks this cache holds; null = every snoop does a tag lookup
+    std::unique_ptr<SnoopFilter> snoop_filter;
+    void filterInsert(addr_t block_addr)
+    {
+        if (snoop_filter)
+            snoop_filter->insert(block_addr);
+    }
+    void filterRemove(addr_t block_addr)
+    {
+        if (snoop_filter)
+            snoop_filter->remove(block_addr);
+    }
+    void rebuildSnoopFilter();
+
+    EventLog *event_log = nullptr; // Null unless a replay log was requested
+    void logEvent(EventKind kind, addr_t block_addr, MESIState before, MESIState after, cycle_t cycle, uint8_t flags = 0)
+    {
+        if (event_log)
+            event_log->record(cycle, kind, id, block_addr, packTransition(before, after), flags);
+    }
+
+
+    // Hot path of access(), specialised for common (s, E, b) so masks, shifts and the tag
+    // search are compile-time constants. GEOMETRY_RUNTIME arguments fall back to the members.
+    template <int SetBits, int Ways, int BlockBits>
+    bool accessWith(addr_t address, Operation op, cycle_t current_cycle);
+    using AccessPath = bool (Cache::*)(addr_t, Operation, cycle_t);
+    AccessPath access_path = nullptr; // Chosen once by selectAccessPath()
+    template <int SetBits, int BlockBits>
+    AccessPath selectWays() const;
+    template <int BlockBits>
+    AccessPath selectSets() const;
+    void selectAccessPath();
+
+    // Optional private L2 between this L1 and the bus. The pair is one coherence agent:
+    // snoops update both levels, and with an inclusive L2 a snoop that misses in the L2
+    // never looks at the L1.
+    std::unique_ptr<L2Cache> l2;
+    bool l2_inclusive = true;
+    cycle_t l2_hit_latency = 0;
+    bool l2_fill_pending = false; // The current miss is being served by the L2
+    addr_t l2_fill_block = 0;
+    cycle_t l2_fill_cycle = 0;
+    void completeL2Fill(cycle_t current_cycle);
+    // Sets the L2 copy's state, installing the block first if install is true
+    void updateL2(addr_t block_addr, MESIState state, bool install, cycle_t current_cycle);
+    void evictFromL2(const L2Cache::Victim &victim, cycle_t current_cycle);
+    void snoopL2(BusTransaction transaction, addr_t block_addr, bool l1_had_copy, SnoopResult &result, cycle_t current_cycle);
+
+    // Optional victim cache behind the L1. Evicted lines move into it with their state, an
+    // L1 miss that finds its block there swaps it back without the bus, and snoops reach
+    // its entries just as they reach L1 lines.
+    std::unique_ptr<VictimCache> victim_cache;
+    cycle_t victim_hit_latency = 0;
+    // Moves block_addr from the victim cache into the L1. Returns true if that completes
+    // the access; a write that finds only a SHARED copy still needs a BusUpgr.
+    bool swapFromVictimCache(addr_t block_addr, unsigned int index, addr_t tag, Operation op, cycle_t current_cycle);
+    void snoopVictimCache(BusTransaction transaction, addr_t block_addr, SnoopResult &result, cycle_t current_cycle);
 
     // Private cache logic functions
+    void issueBusRequest(BusTransaction type, addr_t block_addr, cycle_t current_cycle, uint32_t sector_mask = 0);
     void handleMiss(addr_t address, unsigned int index, addr_t tag, Operation op, cycle_t current_cycle);
     void allocateBlock(addr_t block_addr, unsigned int index, addr_t tag, int& way_index, cycle_t current_cycle); // Finds/evicts way
+    void evictLine(unsigned int index, int way_index, cycle_t current_cycle);
     void initiateWriteback(addr_t victim_address, unsigned int victim_set_index, int victim_way_index, cycle_t current_cycle);
 
 
 public:
-    Cache(int core_id, unsigned int s, unsigned int E, unsigned int b, Bus* shared_bus, Stats* statistics);
+    Cache(int core_id, unsigned int s, unsigned int E, unsigned int b, Interconnect* shared_bus, Stats* statistics);
 
     // Called by the Core
     // Returns true if the access is a hit (completes in 1 cycle), false if miss (stalls core)
     bool access(addr_t address, Operation op, cycle_t current_cycle);
 
-    // Called by the Bus during snooping
-    // Returns results of the snoop (e.g., if data was supplied)
-    SnoopResult snoopRequest(BusTransaction transaction, addr_t address, cycle_t current_cycle);
+    // Called by the Bus during snooping, with a single tag lookup
+    // Returns results of the snoop (whether data was supplied, and in is_shared whether
+    // this cache still holds a valid copy afterwards)
+    // sector_mask is the requester's BusRequest::sector_mask; data is only supplied if this
+    // cache holds all of those sectors
+    SnoopResult snoopRequest(BusTransaction transaction, addr_t address, cycle_t current_cycle, uint32_t sector_mask = 0);
 
     // Called by the Bus when a requested transaction completes
-    // The request that completed is passed in.
-    void handleBusCompletion(const BusRequest& completed_request, cycle_t current_cycle);
+    // The request that completed and the combined snoop result it started with are passed in.
+    void handleBusCompletion(const BusRequest& completed_request, const SnoopResult& snoop_result, cycle_t current_cycle);
 
     // Called by Core/Simulator to check stall status
     bool isStalled() const { return stalled; }
-
-    // Helper for Bus snooping check
-    bool isBlockShared(addr_t address);
+    // Cycles the last hit took beyond the core's hit latency
+    cycle_t lastHitPenalty() const { return hit_penalty; }
+
+    void setWritebackBufferEntries(size_t entries) { writeback_buffer_capacity = entries; }
+    // Splits every block into this many sectors (a power of two, at most 32 and at most one
+    // per 4-byte word). Throws std::invalid_argument otherwise.
+    void setSectors(unsigned int sectors);
+    // Gives each set tags_per_way times as many tags over the same data array, with block
+    // sizes from the model. Must be called before the first access.
+    void setCompression(CompressionModel model, unsigned int tags_per_way, cycle_t decompress_latency, uint64_t seed);
+    // Must be called after setCompression, which changes the number of lines per set
+    void setInsertionPolicy(InsertionPolicy policy);
+    // Predicts with the MRU way or with partial_tag_bits low tag bits; each extra probe
+    // before a hit costs mispredict_penalty cycles
+    void setWayPrediction(WayPrediction prediction, unsigned int partial_tag_bits, cycle_t mispredict_penalty);
+    uint32_t insertionSelector() const { return insertion ? insertion->getSelector() : 0; }
+    void setSnoopFilter(SnoopFilterKind kind);
+    // Valid lines across all sets
+    uint64_t residentBlocks() const;
+    void setEventLog(EventLog *log) { event_log = log; }
+    void setL2(std::unique_ptr<L2Cache> l2_cache, bool inclusive, cycle_t hit_latency);
+    // An L1 miss served by the victim cache costs hit_latency cycles beyond an L1 hit
+    void setVictimCache(unsigned int entries, cycle_t hit_latency);
+
+    // Called every cycle after the bus; finishes a miss the L2 is serving once its latency has passed
+    void tick(cycle_t current_cycle)
+    {
+        if (l2_fill_pending && current_cycle >= l2_fill_cycle)
+            completeL2Fill(current_cycle);
+    }
+    // Asked by the Bus before snooping: false means this cache definitely lacks the block
+    bool mayHoldBlock(addr_t address);
+    // Called by a Bus slice when it has nothing else to do. Hands over the oldest buffered
+    // writeback the slice carries; returns false if there is none.
+    bool popBufferedWriteback(BusRequest &request, cycle_t current_cycle, const Bus &slice);
+
+    // Every line's tag/state/LRU stamp plus outstanding misses
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
 
 };
 
@@ -5,7 +5,8 @@
 
 struct CacheLine {
     MESIState state = MESIState::INVALID;
-    addr_t tag = 0;
+    asid_t asid = 0;   // Address space of the block; extends the tag within the line's padding
+    uint32_t tag = 0;  // Tag bits of the 32-bit address
     cycle_t lastUsedCycle = 0; // For LRU tracking
 
     CacheLine() = default; // Default constructor
@@ -14,5 +15,6 @@ struct CacheLine {
         return state != MESIState::INVALID;
     }
 };
+static_assert(sizeof(CacheLine) == 16, "The ASID must fit in the padding before the tag");
 
 #endif 
\ No newline at end of file
@@ -10,20 +10,45 @@ class CacheSet {
 private:
     std::vector<CacheLine> lines;
     int associativity;
+    // Compressed caches only: each line's size in segments, and the segments the set's
+    // data array holds. Empty/0 when the cache is uncompressed.
+    std::vector<uint8_t> segments;
+    unsigned int segment_budget = 0;
+    int mru_way = 0; // Last way hit or filled at MRU priority
 
 public:
     explicit CacheSet(int E) : associativity(E), lines(E) {}
 
-    // Find a line matching the tag
-    int findLine(addr_t tag) const { 
+    // Find a line matching the tag in address space asid
+    int findLine(addr_t tag, asid_t asid) const { 
         for (int i = 0; i < associativity; ++i) {
-            if (lines[i].isValid() && lines[i].tag == tag) {
+            if (lines[i].isValid() && lines[i].tag == tag && lines[i].asid == asid) {
                 return i; // Found
             }
         }
         return -1; 
     }
 
+    // findLine trying the MRU way first, which saves the scan for most hits in wide sets
+    int findLineMruFirst(addr_t tag, asid_t asid) const {
+        const CacheLine &mru = lines[mru_way];
+        if (mru.isValid() && mru.tag == tag && mru.asid == asid) {
+            return mru_way;
+        }
+        return findLine(tag, asid);
+    }
+
+    // findLine with the associativity fixed at compile time, so the search fully unrolls
+    template <int Ways>
+    int findLineFixed(addr_t tag, asid_t asid) const {
+        for (int i = 0; i < Ways; ++i) {
+            if (lines[i].isValid() && lines[i].tag == tag && lines[i].asid == asid) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
 
     int getLRUVictim() {
         int lru_index = 0;
@@ -52,9 +77,13 @@ public:
     void updateLRU(int index, cycle_t currentCycle) {
          if (index >= 0 && index < associativity) {
             lines[index].lastUsedCycle = currentCycle;
+            mru_way = index;
          }
     }
 
+    int getMruWay() const { return mru_way; }
+    void setMruWay(int index) { mru_way = index; }
+
     CacheLine& getLine(int index) {
         return lines[index];
     }
@@ -70,6 +99,27 @@ public:
         }
         return -1; // No invalid lines
     }
+
+    // Turns the set's lines into tags sharing a data array of budget segments
+    void enableCompression(unsigned int budget) {
+        segment_budget = budget;
+        segments.assign(associativity, 0);
+    }
+    unsigned int getSegments(int index) const { return segments[index]; }
+    void setSegments(int index, unsigned int count) { segments[index] = static_cast<uint8_t>(count); }
+    unsigned int usedSegments() const {
+        unsigned int used = 0;
+        for (int i = 0; i < associativity; ++i) {
+            if (lines[i].isValid()) {
+                used += segments[i];
+            }
+        }
+        return used;
+    }
+    // A compressed block of this size can go in without evicting anything
+    bool fits(unsigned int needed) const {
+        return findInvalidLine() != -1 && usedSegments() + needed <= segment_budget;
+    }
 };
 
 #endif 
\ No newline at end of file
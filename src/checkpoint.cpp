@@ -0,0 +1,98 @@
+#include "checkpoint.h"
+#include <cstdio>
+#include <stdexcept>
+
+CheckpointWriter::CheckpointWriter(const std::string &filename) : path(filename),
+                                                                  tmp_path(filename + ".tmp")
+{
+    file = fopen(tmp_path.c_str(), "wb");
+    if (!file)
+    {
+        throw std::runtime_error("Could not create checkpoint file: " + tmp_path);
+    }
+    put(CHECKPOINT_MAGIC);
+    put(CHECKPOINT_VERSION);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    // Only reached with an open file if commit() never ran, i.e. the snapshot is incomplete
+    if (file)
+    {
+        fclose(file);
+        std::remove(tmp_path.c_str());
+    }
+}
+
+void CheckpointWriter::write(const void *data, size_t len)
+{
+    if (len > 0 && fwrite(data, 1, len, file) != len)
+    {
+        throw std::runtime_error("Short write to checkpoint file: " + tmp_path);
+    }
+}
+
+void CheckpointWriter::commit()
+{
+    bool ok = (fflush(file) == 0);
+    ok = (fclose(file) == 0) && ok;
+    file = nullptr;
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("Could not write checkpoint file: " + path);
+    }
+}
+
+void CheckpointWriter::putRequest(const BusRequest &request)
+{
+    put<int32_t>(request.requestingCoreId);
+    put<uint8_t>(static_cast<uint8_t>(request.type));
+    put<addr_t>(request.address);
+    put<cycle_t>(request.request_cycle);
+    put<uint32_t>(request.sector_mask);
+}
+
+CheckpointReader::CheckpointReader(const std::string &filename) : path(filename)
+{
+    file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        throw std::runtime_error("Could not open checkpoint file: " + path);
+    }
+    if (get<uint32_t>() != CHECKPOINT_MAGIC)
+    {
+        throw std::runtime_error("Not a simulator checkpoint: " + path);
+    }
+    if (get<uint32_t>() != CHECKPOINT_VERSION)
+    {
+        throw std::runtime_error("Unsupported checkpoint version in " + path);
+    }
+}
+
+CheckpointReader::~CheckpointReader()
+{
+    if (file)
+    {
+        fclose(file);
+    }
+}
+
+void CheckpointReader::read(void *data, size_t len)
+{
+    if (len > 0 && fread(data, 1, len, file) != len)
+    {
+        throw std::runtime_error("Checkpoint file is truncated: " + path);
+    }
+}
+
+BusRequest CheckpointReader::getRequest()
+{
+    BusRequest request;
+    request.requestingCoreId = get<int32_t>();
+    request.type = static_cast<BusTransaction>(get<uint8_t>());
+    request.address = get<addr_t>();
+    request.request_cycle = get<cycle_t>();
+    request.sector_mask = get<uint32_t>();
+    return request;
+}
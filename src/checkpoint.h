@@ -0,0 +1,82 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "defs.h"
+
+// Snapshot file layout: magic, version, then each component's state in a fixed order
+// (Simulator -> Stats -> Page map -> Bus -> Caches -> Cores). Values are stored in host byte order,
+// so a checkpoint is only meant to be restored on the machine type that wrote it.
+const uint32_t CHECKPOINT_MAGIC = 0x4b43314c; // "L1CK"
+const uint32_t CHECKPOINT_VERSION = 17;
+
+class CheckpointWriter
+{
+private:
+    std::string path;
+    std::string tmp_path;
+    FILE *file = nullptr;
+
+public:
+    // Writes go to "<path>.tmp"; commit() renames it over path so a crash never leaves a torn snapshot
+    explicit CheckpointWriter(const std::string &filename);
+    ~CheckpointWriter();
+
+    void write(const void *data, size_t len);
+    void commit();
+
+    template <typename T>
+    void put(const T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "put() needs a trivially copyable type");
+        write(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void putVector(const std::vector<T> &values)
+    {
+        put<uint64_t>(values.size());
+        write(values.data(), values.size() * sizeof(T));
+    }
+
+    void putRequest(const BusRequest &request);
+};
+
+class CheckpointReader
+{
+private:
+    std::string path;
+    FILE *file = nullptr;
+
+public:
+    explicit CheckpointReader(const std::string &filename);
+    ~CheckpointReader();
+
+    // Throws std::runtime_error on a short read (truncated or mismatched snapshot)
+    void read(void *data, size_t len);
+
+    template <typename T>
+    T get()
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "get() needs a trivially copyable type");
+        T value;
+        read(&value, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> getVector()
+    {
+        std::vector<T> values(get<uint64_t>());
+        read(values.data(), values.size() * sizeof(T));
+        return values;
+    }
+
+    BusRequest getRequest();
+};
+
+#endif
@@ -0,0 +1,323 @@
+#include "cli_options.h"
+#include <iostream>
+#include <sstream>
+#include <unistd.h> // For getopt
+#include <cstdlib>  // For abort
+#include <cctype>   // For isprint
+#include <algorithm>
+
+void printHelp()
+{
+    std::cout << "Usage: ./L1simulate [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -t <tracefile_base> : Base name of the 4 trace files (e.g., app1)" << std::endl;
+    std::cout << "  -m <manifest>       : Map trace files onto cores from a manifest instead of -t (see README)" << std::endl;
+    std::cout << "  -s <s>              : Number of set index bits (S = 2^s)" << std::endl;
+    std::cout << "  -E <E>              : Associativity (number of lines per set, E > 0)" << std::endl;
+    std::cout << "  -b <b>              : Number of block offset bits (B = 2^b, b >= 2 for 4-byte words)" << std::endl;
+    std::cout << "  -o <outputfile>     : (Optional) File to log output for plotting etc." << std::endl;
+    std::cout << "  -k <checkpointfile> : (Optional) Write state snapshots here (on SIGUSR1, and every -K cycles)" << std::endl;
+    std::cout << "  -K <cycles>         : (Optional) Checkpoint interval in cycles (needs -k)" << std::endl;
+    std::cout << "  -r <checkpointfile> : (Optional) Resume from a snapshot taken with the same -s/-E/-b" << std::endl;
+    std::cout << "  -L <latencyfile>    : (Optional) Timing parameters as 'key = value' lines (see README)" << std::endl;
+    std::cout << "  -w <entries>        : (Optional) Per-core writeback buffer size (default 0 = none)" << std::endl;
+    std::cout << "  -S <entries>        : (Optional) Per-core TSO store buffer size (default 0 = none)" << std::endl;
+    std::cout << "  -x <sectors>        : (Optional) Split each L1 block into sectors fetched separately (default 1 = unsectored)" << std::endl;
+    std::cout << "  -z <model>[:tags]   : (Optional) Compressed L1: model bdi, half or incompressible; tags per way (default 2)" << std::endl;
+    std::cout << "  -I <policy>         : (Optional) L1 insertion policy: lru (default), lip, bip or dip (set dueling)" << std::endl;
+    std::cout << "  -W <predictor>[:bits] : (Optional) L1 way prediction: none (default), mru or partial (partial tags, default 4 bits)" << std::endl;
+    std::cout << "  -V <entries>        : (Optional) Per-core fully associative victim cache behind the L1 (default 0 = none)" << std::endl;
+    std::cout << "  -F <filter>         : (Optional) Snoop filter: none (default), bloom or directory" << std::endl;
+    std::cout << "  -2 <s>:<E>[:policy][:inclusion] : (Optional) Private L2 per core; policy lru|fifo|random, inclusion inclusive|noninclusive" << std::endl;
+    std::cout << "  -A                  : (Optional) Give each core its own address space (ASID = core id)" << std::endl;
+    std::cout << "  -P <policy>[:bits]  : (Optional) Page mapping: none (default), random or first-touch; bits = page offset bits (default 12)" << std::endl;
+    std::cout << "  -B <slices>[:topology] : (Optional) Address-interleaved bus slices; topology bus (default), ring or crossbar" << std::endl;
+    std::cout << "  -a <policy>[:list][:demand-first] : (Optional) Bus arbitration: rr (default), oldest, priority[:order] or weighted[:weights]" << std::endl;
+    std::cout << "  -f                  : (Optional) Report bus waits and each core's slowdown against running alone" << std::endl;
+    std::cout << "  -O <file>[:cycles]  : (Optional) Export all stats as JSON lines (.json/.jsonl) or CSV (.csv), also every <cycles>" << std::endl;
+    std::cout << "  -R <eventlog>       : (Optional) Write a replay log of bus grants and state changes (compare with l1logdiff)" << std::endl;
+    std::cout << "  -h                  : Print this help message" << std::endl;
+}
+
+bool parseCommandLine(int argc, char *argv[], SimConfig &config)
+{
+    long checkpoint_interval = 0;
+    long writeback_entries = 0;
+    long store_buffer_entries = 0;
+    long sector_count = 1;
+    long victim_entries = 0;
+    std::string latency_filename = "";
+    std::string snoop_filter_name = "none";
+    std::string l2_spec = "";
+    std::string page_map_spec = "";
+    std::string arbitration_spec = "";
+    std::string interconnect_spec = "";
+    std::string compression_spec = "";
+    std::string insertion_name = "lru";
+    std::string way_prediction_spec = "";
+    // Use signed int for parsing to easily check for negative, then cast to unsigned
+    long s_long = -1, E_long = -1, b_long = -1;
+    bool s_set = false, E_set = false, b_set = false, t_set = false;
+
+    int opt;
+    // Reset getopt state if necessary (for multiple calls in testing frameworks)
+    optind = 1;
+
+    while ((opt = getopt(argc, argv, "t:m:s:E:b:o:k:K:r:L:w:S:x:z:I:W:V:F:R:O:2:AP:a:B:fh")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            config.trace_base_name = optarg;
+            t_set = true;
+            break;
+        case 'm':
+            config.manifest_path = optarg;
+            t_set = true;
+            break;
+        case 's':
+            try
+            {
+                s_long = std::stol(optarg);
+                s_set = true;
+            }
+            catch (...)
+            { /* Handle error below */
+            }
+            break;
+        case 'E':
+            try
+            {
+                E_long = std::stol(optarg);
+                E_set = true;
+            }
+            catch (...)
+            { /* Handle error below */
+            }
+            break;
+        case 'b':
+            try
+            {
+                b_long = std::stol(optarg);
+                b_set = true;
+            }
+            catch (...)
+            { /* Handle error below */
+            }
+            break;
+        case 'o':
+            config.output_file = optarg;
+            break;
+        case 'k':
+            config.checkpoint_path = optarg;
+            break;
+        case 'K':
+            try
+            {
+                checkpoint_interval = std::stol(optarg);
+            }
+            catch (...)
+            {
+                checkpoint_interval = -1;
+            }
+            break;
+        case 'r':
+            config.restore_path = optarg;
+            break;
+        case 'L':
+            latency_filename = optarg;
+            break;
+        case 'F':
+            snoop_filter_name = optarg;
+            break;
+        case 'R':
+            config.event_log_path = optarg;
+            break;
+        case 'O':
+            config.parseStatsExportSpec(optarg);
+            break;
+        case '2':
+            l2_spec = optarg;
+            break;
+        case 'A':
+            config.private_address_spaces = true;
+            break;
+        case 'P':
+            page_map_spec = optarg;
+            break;
+        case 'a':
+            arbitration_spec = optarg;
+            break;
+        case 'f':
+            config.fairness_report = true;
+            break;
+        case 'B':
+            interconnect_spec = optarg;
+            break;
+        case 'z':
+            compression_spec = optarg;
+            break;
+        case 'w':
+            try
+            {
+                writeback_entries = std::stol(optarg);
+            }
+            catch (...)
+            {
+                writeback_entries = -1;
+            }
+            break;
+        case 'S':
+            try
+            {
+                store_buffer_entries = std::stol(optarg);
+            }
+            catch (...)
+            {
+                store_buffer_entries = -1;
+            }
+            break;
+        case 'x':
+            try
+            {
+                sector_count = std::stol(optarg);
+            }
+            catch (...)
+            {
+                sector_count = -1;
+            }
+            break;
+        case 'I':
+            insertion_name = optarg;
+            break;
+        case 'W':
+            way_prediction_spec = optarg;
+            break;
+        case 'V':
+            try
+            {
+                victim_entries = std::stol(optarg);
+            }
+            catch (...)
+            {
+                victim_entries = -1;
+            }
+            break;
+        case 'h':
+            return false;
+        case '?': // Unknown option or missing argument
+            if (optopt == 't' || optopt == 's' || optopt == 'E' || optopt == 'b' || optopt == 'o' || optopt == 'k' || optopt == 'K' || optopt == 'r' || optopt == 'L' || optopt == 'w' || optopt == 'S' || optopt == 'x' || optopt == 'z' || optopt == 'I' || optopt == 'W' || optopt == 'V' || optopt == 'F' || optopt == 'R' || optopt == 'O' || optopt == '2' || optopt == 'm' || optopt == 'P' || optopt == 'a' || optopt == 'B')
+            {
+                throw CommandLineError(std::string("Option -") + (char)optopt + " requires an argument.", true);
+            }
+            else if (isprint(optopt))
+            {
+                throw CommandLineError(std::string("Unknown option `-") + (char)optopt + "'.", true);
+            }
+            else
+            {
+                std::ostringstream message;
+                message << "Unknown option character `\\x" << std::hex << optopt << "'.";
+                throw CommandLineError(message.str(), true);
+            }
+        default:
+            abort(); // Should not happen
+        }
+    }
+
+    // Check if all required arguments are provided
+    if (!t_set || !s_set || !E_set || !b_set)
+    {
+        throw CommandLineError("Missing required arguments (-t or -m, -s, -E, -b).", true);
+    }
+
+    // Validate argument values
+    if (s_long < 0)
+    {
+        throw CommandLineError("Number of set bits (-s) must be non-negative.");
+    }
+    if (E_long <= 0)
+    {
+        throw CommandLineError("Associativity (-E) must be greater than 0.");
+    }
+    if (b_long < 2)
+    { // Need at least 2 bits for 4-byte offset within block
+        throw CommandLineError("Block offset bits (-b) must be at least 2 (for 4-byte block minimum).");
+    }
+    if (writeback_entries < 0)
+    {
+        throw CommandLineError("Writeback buffer size (-w) must be non-negative.");
+    }
+    if (store_buffer_entries < 0)
+    {
+        throw CommandLineError("Store buffer size (-S) must be non-negative.");
+    }
+    if (sector_count <= 0)
+    {
+        throw CommandLineError("Sectors per block (-x) must be positive.");
+    }
+    if (victim_entries < 0)
+    {
+        throw CommandLineError("Victim cache size (-V) must be non-negative.");
+    }
+    if (checkpoint_interval < 0)
+    {
+        throw CommandLineError("Checkpoint interval (-K) must be a non-negative number of cycles.");
+    }
+    // Add upper bounds? e.g., b < 32, s < 32?
+    if (s_long + b_long > 31)
+    { // Prevent tag bits from becoming negative/zero if s+b >= 32
+        std::cerr << "Warning: s + b (" << s_long << " + " << b_long << ") >= 32. Check address mapping." << std::endl;
+        // Allow it, but be aware of potential zero tag bits.
+    }
+
+    // Cast to unsigned after validation
+    config.s = static_cast<unsigned int>(s_long);
+    config.E = static_cast<unsigned int>(E_long);
+    config.b = static_cast<unsigned int>(b_long);
+    config.checkpoint_interval = static_cast<cycle_t>(checkpoint_interval);
+    config.writeback_buffer_entries = static_cast<unsigned int>(writeback_entries);
+    config.store_buffer_entries = static_cast<unsigned int>(store_buffer_entries);
+    config.sectors = static_cast<unsigned int>(sector_count);
+    config.victim_cache_entries = static_cast<unsigned int>(std::min(victim_entries, 65L));
+
+    try
+    {
+        if (!latency_filename.empty())
+        {
+            config.latency.loadFile(latency_filename);
+        }
+        config.snoop_filter = parseSnoopFilterKind(snoop_filter_name);
+        config.insertion = parseInsertionPolicy(insertion_name);
+        if (!way_prediction_spec.empty())
+        {
+            config.parseWayPredictionSpec(way_prediction_spec);
+        }
+        if (!l2_spec.empty())
+        {
+            config.parseL2Spec(l2_spec);
+        }
+        if (!interconnect_spec.empty())
+        {
+            config.parseInterconnectSpec(interconnect_spec);
+        }
+        if (!compression_spec.empty())
+        {
+            config.parseCompressionSpec(compression_spec);
+        }
+        if (!arbitration_spec.empty())
+        {
+            config.parseArbitrationSpec(arbitration_spec);
+        }
+        if (!page_map_spec.empty())
+        {
+            config.parsePageMapSpec(page_map_spec);
+        }
+        config.validate();
+    }
+    catch (const std::exception &e)
+    {
+        throw CommandLineError(e.what());
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef CLI_OPTIONS_H
+#define CLI_OPTIONS_H
+
+#include <stdexcept>
+#include <string>
+#include "sim_config.h"
+
+// A bad L1simulate command line. what() is the message without the "Error: " prefix;
+// showHelp() says whether the usage text should follow it.
+class CommandLineError : public std::invalid_argument {
+private:
+    bool show_help;
+
+public:
+    explicit CommandLineError(const std::string &message, bool help = false) : std::invalid_argument(message), show_help(help) {}
+    bool showHelp() const { return show_help; }
+};
+
+void printHelp();
+
+// Fills config from L1simulate arguments (argv[0] is the program name) and validates it.
+// Returns false if -h was given. Throws CommandLineError for a bad command line.
+// Uses getopt, so it must not run on two threads at once.
+bool parseCommandLine(int argc, char *argv[], SimConfig &config);
+
+#endif
@@ -0,0 +1,65 @@
+#include "compression.h"
+#include <algorithm>
+#include <stdexcept>
+
+CompressionModel parseCompressionModel(const std::string &name)
+{
+    if (name == "bdi")
+    {
+        return CompressionModel::Bdi;
+    }
+    if (name == "half")
+    {
+        return CompressionModel::Half;
+    }
+    if (name == "incompressible")
+    {
+        return CompressionModel::Incompressible;
+    }
+    throw std::invalid_argument("Unknown compression model '" + name + "' (expected bdi, half or incompressible).");
+}
+
+CompressibilityModel::CompressibilityModel(CompressionModel compression_model, unsigned int block_size, uint64_t model_seed) : model(compression_model),
+                                                                                                                                segments_per_block(std::min(COMPRESSION_SEGMENTS, block_size)),
+                                                                                                                                seed(model_seed)
+{
+    if (block_size < 4)
+    {
+        throw std::invalid_argument("Compressed blocks must be at least 4 bytes.");
+    }
+}
+
+unsigned int CompressibilityModel::segmentsFor(addr_t block_addr) const
+{
+    switch (model)
+    {
+    case CompressionModel::Half:
+        return segments_per_block / 2;
+    case CompressionModel::Bdi:
+    {
+        // splitmix64 finaliser: neighbouring blocks get unrelated sizes
+        uint64_t h = block_addr ^ seed;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        h ^= h >> 31;
+        unsigned int bucket = static_cast<unsigned int>(h % 100);
+        if (bucket < 20)
+        {
+            return 1; // All zeros or one repeated value
+        }
+        if (bucket < 50)
+        {
+            return std::max(1u, segments_per_block / 4); // Narrow deltas from one base
+        }
+        if (bucket < 75)
+        {
+            return segments_per_block / 2; // Wider deltas
+        }
+        return segments_per_block;
+    }
+    case CompressionModel::None:
+    case CompressionModel::Incompressible:
+        break;
+    }
+    return segments_per_block;
+}
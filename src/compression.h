@@ -0,0 +1,38 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <string>
+#include "defs.h"
+
+// Where compressed block sizes come from. Traces carry addresses but no data, so each
+// model assigns every block a fixed size from its address.
+enum class CompressionModel {
+    None,          // L1 compression off
+    Bdi,           // Base-delta-immediate style mix: zero, narrow, half-width and incompressible blocks
+    Half,          // Every block compresses to half its size
+    Incompressible // Every block keeps its full size; only the extra tags remain
+};
+
+// Throws std::invalid_argument for anything other than "bdi", "half" or "incompressible"
+CompressionModel parseCompressionModel(const std::string &name);
+
+// Compressed size of each block, in segments. A block is split into up to
+// COMPRESSION_SEGMENTS segments (one per byte for tiny blocks), and a compressed line
+// occupies a whole number of them.
+const unsigned int COMPRESSION_SEGMENTS = 8;
+
+class CompressibilityModel {
+private:
+    CompressionModel model;
+    unsigned int segments_per_block;
+    uint64_t seed;
+
+public:
+    CompressibilityModel(CompressionModel compression_model, unsigned int block_size, uint64_t model_seed);
+
+    unsigned int segmentsPerBlock() const { return segments_per_block; }
+    // Between 1 and segmentsPerBlock(); the same block always gets the same size
+    unsigned int segmentsFor(addr_t block_addr) const;
+};
+
+#endif
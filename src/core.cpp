@@ -1,10 +1,18 @@
 #include "core.h"
+#include "checkpoint.h"
+#include "profile.h"
 #include <iostream>
 #include <stdexcept>
 #include <cstring>
 
 Core::Core(int core_id, const std::string& trace_filename, Cache* l1_cache, Stats* statistics) :
-    id(core_id), cache(l1_cache), stats(statistics)
+    // TraceReader::open throws if the file is missing or uses a compression format this build lacks
+    Core(core_id, TraceReader::open(trace_filename), l1_cache, statistics)
+{
+}
+
+Core::Core(int core_id, std::unique_ptr<TraceReader> reader, Cache* l1_cache, Stats* statistics) :
+    id(core_id), cache(l1_cache), stats(statistics), trace_reader(std::move(reader))
 {
     if (!cache) {
         throw std::invalid_argument("Core must have a valid cache pointer.");
@@ -12,31 +20,117 @@ Core::Core(int core_id, const std::string& trace_filename, Cache* l1_cache, Stat
     if (!stats) {
         throw std::invalid_argument("Core must have a valid stats pointer.");
     }
+    if (!trace_reader) {
+        throw std::invalid_argument("Core must have a valid trace reader.");
+    }
+}
 
-    trace_file_ptr = fopen(trace_filename.c_str(), "r");
-    if (!trace_file_ptr) {
-        throw std::runtime_error("Could not open trace file: " + trace_filename + " (fopen failed)");
+Core::Core(int core_id, Cache* l1_cache, Stats* statistics) :
+    id(core_id), cache(l1_cache), stats(statistics), push_mode(true)
+{
+    if (!cache) {
+        throw std::invalid_argument("Core must have a valid cache pointer.");
+    }
+    if (!stats) {
+        throw std::invalid_argument("Core must have a valid stats pointer.");
     }
 }
 
-Core::~Core() {
-    if (trace_file_ptr) {
-        fclose(trace_file_ptr);
-        trace_file_ptr = nullptr;
+void Core::pushAccess(const MemAccess& access) {
+    if (!push_mode || input_closed) {
+        throw std::logic_error("Core " + std::to_string(id) + " does not accept pushed accesses.");
     }
+    pushed_accesses.push_back(access);
+}
+
+void Core::closeInput() {
+    input_closed = true;
+}
+
+bool Core::needsInput() const {
+    return push_mode && !input_closed && pushed_accesses.empty() && !processing_access &&
+           !core_stalled_on_cache && !needs_completion_cycle && hit_cycles_left == 0;
 }
 
 bool Core::isFinished() const {
-    return trace_finished && !core_stalled_on_cache && !needs_completion_cycle;
+    return trace_finished && !core_stalled_on_cache && !needs_completion_cycle && hit_cycles_left == 0 &&
+           store_buffer.empty() && !drain_in_flight;
+}
+
+void Core::saveState(CheckpointWriter& out) const {
+    out.put<uint64_t>(trace_reader ? trace_reader->position() : 0);
+    out.put<uint8_t>(trace_finished);
+    out.put(internal_cycle);
+    out.put(hit_cycles_left);
+    out.put<uint8_t>(core_stalled_on_cache);
+    out.put<uint8_t>(needs_completion_cycle);
+    out.put<uint8_t>(static_cast<uint8_t>(current_access.type));
+    out.put(current_access.address);
+    out.put<uint8_t>(processing_access);
+    out.put<uint8_t>(input_closed);
+    out.put<uint64_t>(pushed_accesses.size());
+    for (const MemAccess& access : pushed_accesses) {
+        out.put<uint8_t>(static_cast<uint8_t>(access.type));
+        out.put(access.address);
+    }
+    out.put<uint64_t>(store_buffer.size());
+    for (addr_t address : store_buffer) {
+        out.put(address);
+    }
+    out.put<uint8_t>(drain_in_flight);
+}
+
+void Core::loadState(CheckpointReader& in) {
+    uint64_t trace_offset = in.get<uint64_t>();
+    if (trace_reader) {
+        trace_reader->seek(trace_offset);
+    }
+    trace_finished = in.get<uint8_t>() != 0;
+    internal_cycle = in.get<cycle_t>();
+    hit_cycles_left = in.get<cycle_t>();
+    core_stalled_on_cache = in.get<uint8_t>() != 0;
+    needs_completion_cycle = in.get<uint8_t>() != 0;
+    current_access.type = static_cast<Operation>(in.get<uint8_t>());
+    current_access.address = in.get<addr_t>();
+    processing_access = in.get<uint8_t>() != 0;
+    input_closed = in.get<uint8_t>() != 0;
+    pushed_accesses.clear();
+    uint64_t pushed_count = in.get<uint64_t>();
+    for (uint64_t i = 0; i < pushed_count; ++i) {
+        MemAccess access;
+        access.type = static_cast<Operation>(in.get<uint8_t>());
+        access.address = in.get<addr_t>();
+        pushed_accesses.push_back(access);
+    }
+    store_buffer.clear();
+    uint64_t buffered_count = in.get<uint64_t>();
+    for (uint64_t i = 0; i < buffered_count; ++i) {
+        store_buffer.push_back(in.get<addr_t>());
+    }
+    drain_in_flight = in.get<uint8_t>() != 0;
 }
 
 bool Core::readAndParseNextAccess() {
-    if (!trace_file_ptr || feof(trace_file_ptr)) {
-        trace_finished = true;
-        return false;
+    L1SIM_PROFILE_ZONE(TraceRead);
+    if (push_mode) {
+        if (pushed_accesses.empty()) {
+            trace_finished = input_closed; // Otherwise just wait for the next push
+            return false;
+        }
+        current_access = pushed_accesses.front();
+        pushed_accesses.pop_front();
+        return true;
+    }
+
+    if (trace_reader && trace_reader->isBinary()) {
+        if (!trace_reader->readRecord(current_access)) {
+            trace_finished = !trace_reader->wouldBlock(); // Otherwise wait for another core to catch up
+            return false;
+        }
+        return true;
     }
 
-    if (fgets(line_buffer, CORE_LINE_BUFFER_SIZE, trace_file_ptr) == nullptr) {
+    if (!trace_reader || !trace_reader->readLine(line_buffer, CORE_LINE_BUFFER_SIZE)) {
         trace_finished = true;
         return false;
     }
@@ -57,8 +151,53 @@ bool Core::readAndParseNextAccess() {
     }
 }
 
+bool Core::forwardsFromStoreBuffer(addr_t address) const {
+    for (addr_t buffered : store_buffer) {
+        if (buffered == address) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Core::drainStoreBuffer(cycle_t global_cycle) {
+    if (drain_in_flight) {
+        if (cache->isStalled()) {
+            return;
+        }
+        // The fill for the head store completed; the write was applied with it
+        drain_in_flight = false;
+        store_buffer.pop_front();
+        return;
+    }
+    if (store_buffer.empty() || cache->isStalled()) {
+        return;
+    }
+    if (cache->access(store_buffer.front(), Operation::WRITE, global_cycle)) {
+        store_buffer.pop_front();
+    } else {
+        drain_in_flight = true;
+    }
+}
+
 void Core::tick(cycle_t global_cycle) {
     internal_cycle = global_cycle;
+    if (global_cycle < start_cycle) {
+        return;
+    }
+
+    // The drain goes first so a store it retires this cycle is visible to the core's access
+    if (store_buffer_capacity > 0) {
+        drainStoreBuffer(global_cycle);
+    }
+    executeCycle(global_cycle);
+}
+
+void Core::executeCycle(cycle_t global_cycle) {
+    if (hit_cycles_left > 0) {
+        hit_cycles_left--;
+        return;
+    }
 
     if (needs_completion_cycle) {
         needs_completion_cycle = false;
@@ -81,10 +220,40 @@ void Core::tick(cycle_t global_cycle) {
     if (!core_stalled_on_cache && !trace_finished) {
         if (!processing_access) {
             if (readAndParseNextAccess()) {
+                current_access.address = withAsid(current_access.address, asid);
+                if (page_map) {
+                    current_access.address = page_map->translate(current_access.address);
+                }
                 processing_access = true;
             } else {
-                trace_finished = true;
+                // End of trace (trace_finished is set), or a core waiting for input
+                processing_access = false;
+                return;
+            }
+        }
+
+        if (processing_access && store_buffer_capacity > 0) {
+            if (current_access.type == Operation::WRITE) {
+                if (store_buffer.size() >= store_buffer_capacity) {
+                    stats->recordStoreBufferFull(id);
+                    stats->incrementStallCycles(id);
+                    return;
+                }
+                // Retires at once; the cache sees it when it reaches the head of the buffer
+                store_buffer.push_back(current_access.address);
+                processing_access = false;
+                return;
+            }
+            if (forwardsFromStoreBuffer(current_access.address)) {
+                stats->recordAccess(id, Operation::READ);
+                stats->recordStoreBufferForward(id);
                 processing_access = false;
+                hit_cycles_left = hit_latency - 1;
+                return;
+            }
+            if (drain_in_flight) {
+                // The cache is busy fetching a block for the store buffer
+                stats->incrementStallCycles(id);
                 return;
             }
         }
@@ -94,6 +263,7 @@ void Core::tick(cycle_t global_cycle) {
 
             if (hit) {
                 processing_access = false;
+                hit_cycles_left = hit_latency - 1 + cache->lastHitPenalty();
             } else {
                 core_stalled_on_cache = true;
                 stats->incrementStallCycles(id);
@@ -2,11 +2,17 @@
 #define CORE_H
 
 #include <string>
-#include <cstdio> // For FILE*, fopen, fgets, sscanf, fclose
+#include <cstdio> // For sscanf
 #include <memory>
+#include <deque>
 #include "defs.h"
 #include "cache.h"
 #include "stats.h"
+#include "trace_reader.h"
+#include "page_map.h"
+
+class CheckpointWriter;
+class CheckpointReader;
 
 // Optimization done By Defining a buffer size for reading lines
 #define CORE_LINE_BUFFER_SIZE 256 // will be enough for "R/W 0xADDRESS\n\0"
@@ -18,12 +24,21 @@ private:
     Cache *cache; // Pointer to its L1 cache
     Stats *stats; // Pointer to global stats object
 
-    FILE *trace_file_ptr = nullptr;
+    std::unique_ptr<TraceReader> trace_reader; // Plain or compressed trace stream
     char line_buffer[CORE_LINE_BUFFER_SIZE];
 
     bool trace_finished = false;
     cycle_t internal_cycle = 0;
 
+    cycle_t hit_latency = L1_HIT_CYCLES;
+    cycle_t hit_cycles_left = 0; // Remaining cycles of a multi-cycle hit
+    cycle_t start_cycle = 0;
+
+    // Address space of this core's stream; trace addresses are tagged with it, then
+    // translated by the shared page map if there is one
+    asid_t asid = 0;
+    PageMap *page_map = nullptr;
+
     bool core_stalled_on_cache = false;
     // Flag for post-miss completion cycle
     bool needs_completion_cycle = false;
@@ -31,16 +46,55 @@ private:
     MemAccess current_access;
     bool processing_access = false;
 
+    // Push mode: accesses arrive through pushAccess() instead of a trace file
+    bool push_mode = false;
+    bool input_closed = false;
+    std::deque<MemAccess> pushed_accesses;
+
+    // Optional TSO store buffer: writes retire into it and drain to the cache in order
+    // through a separate write port, one store per cycle
+    size_t store_buffer_capacity = 0; // 0 = disabled, writes block like reads
+    std::deque<addr_t> store_buffer;  // Oldest first
+    bool drain_in_flight = false;     // Head store missed and the cache is fetching its block
+
     bool readAndParseNextAccess();
+    // Runs the pipeline for one cycle
+    void executeCycle(cycle_t global_cycle);
+    void drainStoreBuffer(cycle_t global_cycle);
+    bool forwardsFromStoreBuffer(addr_t address) const;
 
 public:
     Core(int core_id, const std::string &trace_filename, Cache *l1_cache, Stats *statistics);
-    ~Core();
+    // Reads from an already opened stream (e.g. one core's share of a multiplexed input)
+    Core(int core_id, std::unique_ptr<TraceReader> reader, Cache *l1_cache, Stats *statistics);
+    // Push-mode core with no trace file
+    Core(int core_id, Cache *l1_cache, Stats *statistics);
+
+    void pushAccess(const MemAccess &access);
+    // No more accesses will be pushed; the core finishes once its queue drains
+    void closeInput();
+    // True when a push-mode core is idle only because its queue is empty
+    bool needsInput() const;
+
+    // Cycles a hit occupies the core (default L1_HIT_CYCLES)
+    void setHitLatency(cycle_t cycles) { hit_latency = cycles; }
+    // The core stays idle (without counting stall cycles) until this cycle
+    void setStartCycle(cycle_t cycle) { start_cycle = cycle; }
+    void setStoreBufferEntries(size_t entries) { store_buffer_capacity = entries; }
+    void setAddressSpace(asid_t space, PageMap *map)
+    {
+        asid = space;
+        page_map = map;
+    }
 
     // Execute one cycle worth of work for this core
     void tick(cycle_t global_cycle);
 
     bool isFinished() const;
+
+    // Pipeline flags, the access in flight and the trace read offset
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
     cycle_t getCycle() const { return internal_cycle; } // Return cycles processed by this core
 };
 
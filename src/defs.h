@@ -5,12 +5,21 @@
 #include <vector>  // Added for SnoopResult sharers
 
 // Type Definitions
-using addr_t = uint32_t;       // 32-bit addresses
+// Simulated address: the 32-bit trace address, with the stream's address-space ID in the
+// bits above ASID_SHIFT so identical addresses from different processes never alias
+using addr_t = uint64_t;
+using asid_t = uint16_t;
+const unsigned int ASID_SHIFT = 32;
 using cycle_t = uint64_t;     // Cycle counter (can get large)
+// Build with e.g. `make CORES=8` to simulate more cores
+#ifdef L1SIM_NUM_CORES
+const int NUM_CORES = L1SIM_NUM_CORES;
+#else
 const int NUM_CORES = 4;
+#endif
 
 // MESI States
-enum class MESIState {
+enum class MESIState : uint8_t {
     INVALID,
     SHARED,
     EXCLUSIVE,
@@ -39,6 +48,12 @@ const cycle_t MEM_ACCESS_CYCLES = 100; // Additional cycles for memory fetch/wri
 // const cycle_t BUS_UPDATE_CYCLES = 2; // Word transfer (BusUpdate) - Not directly used, C2C block transfer used
 const cycle_t C2C_BLOCK_TRANSFER_CYCLE_FACTOR = 2; // Per word (N = block_size / 4)
 
+inline asid_t asidOf(addr_t address) { return static_cast<asid_t>(address >> ASID_SHIFT); }
+inline addr_t withAsid(addr_t address, asid_t asid)
+{
+    return (address & ((addr_t(1) << ASID_SHIFT) - 1)) | (addr_t(asid) << ASID_SHIFT);
+}
+
 // Struct to represent a memory access request
 struct MemAccess {
     Operation type;
@@ -51,6 +66,7 @@ struct BusRequest {
     BusTransaction type = BusTransaction::NoTransaction;
     addr_t address = 0;
     cycle_t request_cycle = 0; // Cycle when request was added to queue
+    uint32_t sector_mask = 0;  // Sectors moved (bit i = sector i) on a sectored cache; 0 = whole block
 };
 
 // Struct for snooping results
@@ -0,0 +1,84 @@
+#include "event_log.h"
+#include <iostream>
+#include <stdexcept>
+
+EventLog::EventLog(const std::string &filename) : path(filename)
+{
+    file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        throw std::runtime_error("Could not create event log: " + path);
+    }
+    setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    if (fwrite(&EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC), 1, file) != 1 ||
+        fwrite(&EVENT_LOG_VERSION, sizeof(EVENT_LOG_VERSION), 1, file) != 1)
+    {
+        throw std::runtime_error("Short write to event log: " + path);
+    }
+}
+
+EventLog::~EventLog()
+{
+    if (file && fclose(file) != 0)
+    {
+        std::cerr << "Warning: Could not finish writing event log " << path << std::endl;
+    }
+}
+
+void EventLog::record(cycle_t cycle, EventKind kind, int core, addr_t block_addr, uint8_t detail, uint8_t flags)
+{
+    EventRecord event;
+    event.cycle = cycle;
+    event.block_addr = static_cast<uint32_t>(block_addr);
+    event.kind = static_cast<uint8_t>(kind);
+    event.core = static_cast<uint8_t>(core);
+    event.detail = detail;
+    event.flags = flags;
+
+    hash = mixEventHash(hash, event);
+    event_count++;
+    if (fwrite(&event, sizeof(event), 1, file) != 1)
+    {
+        throw std::runtime_error("Short write to event log: " + path);
+    }
+}
+
+EventLogReader::EventLogReader(const std::string &filename) : path(filename)
+{
+    file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        throw std::runtime_error("Could not open event log: " + path);
+    }
+    uint32_t magic = 0, version = 0;
+    if (fread(&magic, sizeof(magic), 1, file) != 1 || fread(&version, sizeof(version), 1, file) != 1 ||
+        magic != EVENT_LOG_MAGIC)
+    {
+        fclose(file);
+        throw std::runtime_error(path + " is not an event log.");
+    }
+    if (version != EVENT_LOG_VERSION)
+    {
+        fclose(file);
+        throw std::runtime_error(path + " has unsupported event log version " + std::to_string(version) + ".");
+    }
+}
+
+EventLogReader::~EventLogReader()
+{
+    fclose(file);
+}
+
+bool EventLogReader::next(EventRecord &record)
+{
+    size_t got = fread(&record, 1, sizeof(record), file);
+    if (got == 0)
+    {
+        return false;
+    }
+    if (got != sizeof(record))
+    {
+        throw std::runtime_error("Truncated record at end of event log: " + path);
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "defs.h"
+
+// Replay log: one fixed-size record per coherence-visible event, in simulation order.
+// Two engine variants that agree on every record agree on every statistic, so comparing
+// logs (or just their rolling hashes) checks a faster engine against the reference one.
+const uint32_t EVENT_LOG_MAGIC = 0x5645314c; // "L1EV"
+const uint32_t EVENT_LOG_VERSION = 1;
+
+enum class EventKind : uint8_t {
+    BusGrant = 1, // detail = BusTransaction, flags = combined snoop outcome
+    Snoop = 2,    // A snooped cache changed state or supplied data
+    Fill = 3,     // Bus transaction completed in the requester's cache
+    Upgrade = 4,  // Silent EXCLUSIVE -> MODIFIED on a write hit
+    Eviction = 5  // Valid line replaced
+};
+
+// Snoop outcome bits in EventRecord::flags
+const uint8_t EVENT_DATA_SUPPLIED = 1;
+const uint8_t EVENT_SHARED = 2;
+
+// 16 bytes on disk, host byte order (like checkpoints). For state transitions, detail
+// holds the state before in the high nibble and the state after in the low nibble.
+// block_addr drops the ASID: each core runs one address space, so core implies it.
+struct EventRecord {
+    uint64_t cycle = 0;
+    uint32_t block_addr = 0;
+    uint8_t kind = 0;
+    uint8_t core = 0;
+    uint8_t detail = 0;
+    uint8_t flags = 0;
+};
+static_assert(sizeof(EventRecord) == 16, "EventRecord must stay 16 bytes");
+
+// FNV-1a over the record's two 64-bit words
+inline uint64_t mixEventHash(uint64_t hash, const EventRecord &record)
+{
+    const uint64_t prime = 0x100000001b3ull;
+    uint64_t second = record.block_addr | (uint64_t(record.kind) << 32) | (uint64_t(record.core) << 40) |
+                      (uint64_t(record.detail) << 48) | (uint64_t(record.flags) << 56);
+    hash = (hash ^ record.cycle) * prime;
+    return (hash ^ second) * prime;
+}
+const uint64_t EVENT_HASH_SEED = 0xcbf29ce484222325ull;
+
+inline uint8_t packTransition(MESIState before, MESIState after)
+{
+    return static_cast<uint8_t>((static_cast<uint8_t>(before) << 4) | static_cast<uint8_t>(after));
+}
+
+class EventLog
+{
+private:
+    std::string path;
+    FILE *file = nullptr;
+    uint64_t event_count = 0;
+    uint64_t hash = EVENT_HASH_SEED;
+
+public:
+    // Throws std::runtime_error if the file cannot be created
+    explicit EventLog(const std::string &filename);
+    ~EventLog();
+
+    void record(cycle_t cycle, EventKind kind, int core, addr_t block_addr, uint8_t detail, uint8_t flags = 0);
+
+    uint64_t getEventCount() const { return event_count; }
+    uint64_t getHash() const { return hash; }
+};
+
+class EventLogReader
+{
+private:
+    std::string path;
+    FILE *file = nullptr;
+
+public:
+    // Throws std::runtime_error if the file is missing or is not an event log
+    explicit EventLogReader(const std::string &filename);
+    ~EventLogReader();
+
+    // Returns false at end of log; throws on a truncated record
+    bool next(EventRecord &record);
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "insertion_policy.h"
+#include "checkpoint.h"
+#include <algorithm>
+#include <stdexcept>
+
+InsertionPolicy parseInsertionPolicy(const std::string &name)
+{
+    if (name == "lru")
+    {
+        return InsertionPolicy::LRU;
+    }
+    if (name == "lip")
+    {
+        return InsertionPolicy::LIP;
+    }
+    if (name == "bip")
+    {
+        return InsertionPolicy::BIP;
+    }
+    if (name == "dip")
+    {
+        return InsertionPolicy::DIP;
+    }
+    throw std::invalid_argument("Unknown insertion policy '" + name + "' (expected lru, lip, bip or dip).");
+}
+
+InsertionSelector::InsertionSelector(InsertionPolicy insertion_policy, unsigned int num_sets) : policy(insertion_policy),
+                                                                                               leader_period(std::clamp(num_sets / 2, 2u, 32u))
+{
+}
+
+bool InsertionSelector::bimodalLowPriority()
+{
+    // Deterministic rather than random, so runs stay reproducible
+    bimodal_count = (bimodal_count + 1) % BIP_MRU_PERIOD;
+    return bimodal_count != 0;
+}
+
+bool InsertionSelector::insertAtLru(unsigned int index)
+{
+    switch (policy)
+    {
+    case InsertionPolicy::LRU:
+        return false;
+    case InsertionPolicy::LIP:
+        return true;
+    case InsertionPolicy::BIP:
+        return bimodalLowPriority();
+    case InsertionPolicy::DIP:
+        break;
+    }
+
+    unsigned int position = index % leader_period;
+    if (position == 0)
+    {
+        selector = std::min(selector + 1, DIP_SELECTOR_MAX);
+        return false;
+    }
+    if (position == leader_period / 2)
+    {
+        selector = selector > 0 ? selector - 1 : 0;
+        return bimodalLowPriority();
+    }
+    return selector > DIP_SELECTOR_MAX / 2 ? bimodalLowPriority() : false;
+}
+
+void InsertionSelector::saveState(CheckpointWriter &out) const
+{
+    out.put(selector);
+    out.put(bimodal_count);
+}
+
+void InsertionSelector::loadState(CheckpointReader &in)
+{
+    selector = in.get<uint32_t>();
+    bimodal_count = in.get<uint32_t>();
+}
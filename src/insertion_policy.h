@@ -0,0 +1,50 @@
+#ifndef INSERTION_POLICY_H
+#define INSERTION_POLICY_H
+
+#include <string>
+#include <cstdint>
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Where a block filled into the L1 enters its set's recency order. Victims are always
+// chosen LRU; only the position of new blocks changes.
+enum class InsertionPolicy {
+    LRU, // Every fill goes to the MRU position
+    LIP, // Every fill goes to the LRU position, so it is the next victim unless reused
+    BIP, // LIP, except one fill in BIP_MRU_PERIOD goes to MRU
+    DIP  // Set dueling between LRU and BIP, followers use whichever misses less
+};
+
+// Throws std::invalid_argument for anything other than "lru", "lip", "bip" or "dip"
+InsertionPolicy parseInsertionPolicy(const std::string &name);
+
+const unsigned int BIP_MRU_PERIOD = 32;
+const unsigned int DIP_SELECTOR_MAX = 1023; // 10-bit saturating policy selector
+
+// Per-cache insertion decisions. Under DIP every leader_period-th set is an LRU leader,
+// the sets halfway between are BIP leaders, and the rest follow the selector: a miss in
+// an LRU leader counts towards BIP, a miss in a BIP leader towards LRU.
+class InsertionSelector {
+private:
+    InsertionPolicy policy;
+    unsigned int leader_period;
+    uint32_t selector = DIP_SELECTOR_MAX / 2; // Followers start with LRU
+    uint32_t bimodal_count = 0;
+
+    bool bimodalLowPriority();
+
+public:
+    InsertionSelector(InsertionPolicy insertion_policy, unsigned int num_sets);
+
+    // Called once for each block filled into set index after a miss; true means the block
+    // goes to the LRU position
+    bool insertAtLru(unsigned int index);
+    // Above the midpoint, DIP followers use BIP
+    uint32_t getSelector() const { return selector; }
+
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
+
+#endif
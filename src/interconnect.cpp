@@ -0,0 +1,144 @@
+#include "interconnect.h"
+#include "bus.h"
+#include "checkpoint.h"
+#include <algorithm>
+#include <stdexcept>
+
+InterconnectTopology parseInterconnectTopology(const std::string &name)
+{
+    if (name == "bus")
+    {
+        return InterconnectTopology::Bus;
+    }
+    if (name == "ring")
+    {
+        return InterconnectTopology::Ring;
+    }
+    if (name == "crossbar")
+    {
+        return InterconnectTopology::Crossbar;
+    }
+    throw std::invalid_argument("Unknown interconnect topology '" + name + "' (expected bus, ring or crossbar).");
+}
+
+Interconnect::Interconnect(unsigned int slice_count, InterconnectTopology topo, unsigned int block_size,
+                           Stats *statistics, const LatencyConfig &latency) : block_bits(0),
+                                                                              topology(topo),
+                                                                              hop_latency(latency.hop_latency)
+{
+    if (slice_count == 0)
+    {
+        throw std::invalid_argument("The interconnect needs at least one bus slice.");
+    }
+    while ((1u << block_bits) < block_size)
+    {
+        block_bits++;
+    }
+
+    for (unsigned int k = 0; k < slice_count; ++k)
+    {
+        // Round-trip traversal cost from each core to this slice
+        std::vector<cycle_t> traversal(NUM_CORES, 0);
+        int stop = static_cast<int>(k * NUM_CORES / slice_count);
+        for (int core = 0; core < NUM_CORES; ++core)
+        {
+            int hops = 0;
+            if (topology == InterconnectTopology::Ring)
+            {
+                int distance = std::abs(core - stop);
+                hops = std::min(distance, NUM_CORES - distance);
+            }
+            else if (topology == InterconnectTopology::Crossbar)
+            {
+                hops = 1;
+            }
+            traversal[core] = 2 * hops * hop_latency;
+        }
+        slices.push_back(std::make_unique<Bus>(block_size, statistics, latency));
+        slices.back()->setSlice(k, slice_count, block_bits, traversal);
+    }
+}
+
+Interconnect::~Interconnect() = default;
+
+Bus &Interconnect::sliceFor(addr_t address) const
+{
+    return *slices[(address >> block_bits) % slices.size()];
+}
+
+void Interconnect::registerCache(Cache *cache)
+{
+    for (const auto &bus : slices)
+    {
+        bus->registerCache(cache);
+    }
+}
+
+bool Interconnect::addRequest(const BusRequest &request)
+{
+    return sliceFor(request.address).addRequest(request);
+}
+
+void Interconnect::setEventLog(EventLog *log)
+{
+    for (const auto &bus : slices)
+    {
+        bus->setEventLog(log);
+    }
+}
+
+void Interconnect::setSectors(unsigned int sectors)
+{
+    for (const auto &bus : slices)
+    {
+        bus->setSectors(sectors);
+    }
+}
+
+void Interconnect::setArbitration(ArbitrationPolicy policy, const std::vector<int> &order,
+                                  const std::vector<unsigned int> &weights, bool demand_over_writeback)
+{
+    for (const auto &bus : slices)
+    {
+        bus->setArbitration(policy, order, weights, demand_over_writeback);
+    }
+}
+
+void Interconnect::tick(cycle_t current_cycle)
+{
+    for (const auto &bus : slices)
+    {
+        bus->tick(current_cycle);
+    }
+}
+
+uint64_t Interconnect::getTotalTransactions() const
+{
+    uint64_t total = 0;
+    for (const auto &bus : slices)
+    {
+        total += bus->getTotalTransactions();
+    }
+    return total;
+}
+
+void Interconnect::saveState(CheckpointWriter &out) const
+{
+    out.put<uint32_t>(static_cast<uint32_t>(slices.size()));
+    for (const auto &bus : slices)
+    {
+        bus->saveState(out);
+    }
+}
+
+void Interconnect::loadState(CheckpointReader &in)
+{
+    if (in.get<uint32_t>() != slices.size())
+    {
+        throw std::runtime_error("Checkpoint was taken with a different number of bus slices.");
+    }
+    for (const auto &bus : slices)
+    {
+        bus->loadState(in);
+    }
+}
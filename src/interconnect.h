@@ -0,0 +1,68 @@
+#ifndef INTERCONNECT_H
+#define INTERCONNECT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "defs.h"
+#include "latency_config.h"
+#include "arbitration.h"
+
+class Bus;
+class Cache;
+class Stats;
+class EventLog;
+class CheckpointWriter;
+class CheckpointReader;
+
+// How requests travel between the cores and the bus slices
+enum class InterconnectTopology {
+    Bus,     // Shared wires: no traversal cost
+    Ring,    // Bidirectional ring with one stop per core; slices sit at evenly spaced stops
+    Crossbar // One switch hop between any core and any slice
+};
+
+// Throws std::invalid_argument for anything other than "bus", "ring" or "crossbar"
+InterconnectTopology parseInterconnectTopology(const std::string &name);
+
+// The caches' view of the bus: one or more independent snooping Bus slices, with
+// consecutive blocks interleaved across them. Every transaction for a block goes to the
+// same slice, so each slice keeps coherence for its blocks with its own queues,
+// arbitration and snooping. A transaction holds its slice while the request travels to
+// it and the response travels back (hop_latency per hop each way).
+class Interconnect {
+private:
+    std::vector<std::unique_ptr<Bus>> slices;
+    unsigned int block_bits;
+    InterconnectTopology topology;
+    cycle_t hop_latency;
+
+public:
+    // Throws std::invalid_argument if slice_count is 0
+    Interconnect(unsigned int slice_count, InterconnectTopology topo, unsigned int block_size,
+                 Stats *statistics, const LatencyConfig &latency);
+    ~Interconnect();
+
+    Bus &sliceFor(addr_t address) const;
+    size_t sliceCount() const { return slices.size(); }
+    const Bus &slice(size_t index) const { return *slices[index]; }
+    InterconnectTopology getTopology() const { return topology; }
+    cycle_t getHopLatency() const { return hop_latency; }
+
+    void registerCache(Cache *cache);
+    bool addRequest(const BusRequest &request);
+    void setEventLog(EventLog *log);
+    void setSectors(unsigned int sectors);
+    void setArbitration(ArbitrationPolicy policy, const std::vector<int> &order,
+                        const std::vector<unsigned int> &weights, bool demand_over_writeback);
+
+    // Ticks every slice in index order
+    void tick(cycle_t current_cycle);
+
+    uint64_t getTotalTransactions() const;
+
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
+
+#endif
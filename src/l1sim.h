@@ -0,0 +1,19 @@
+#ifndef L1SIM_H
+#define L1SIM_H
+
+// Public header for embedding the simulator. Link against libl1sim.a
+// (plus -pthread, and -lz/-lzstd/-llz4 for whichever trace decoders it was built with).
+//
+//   SimConfig config;            // geometry, optional trace base name, checkpoints
+//   Simulator sim(config);       // empty trace_base_name = push mode
+//   sim.pushAccess(core, {Operation::READ, addr});
+//   sim.runUntilInputNeeded();   // simulate until some core runs dry
+//   sim.closeInput(core);        // then sim.run() drains everything
+//   sim.getCoreStats(core).miss_rate;
+
+#include "defs.h"
+#include "sim_config.h"
+#include "stats.h"
+#include "simulator.h"
+
+#endif
@@ -0,0 +1,149 @@
+#include "l2_cache.h"
+#include "checkpoint.h"
+#include <stdexcept>
+
+ReplacementPolicy parseReplacementPolicy(const std::string &name)
+{
+    if (name == "lru")
+    {
+        return ReplacementPolicy::LRU;
+    }
+    if (name == "fifo")
+    {
+        return ReplacementPolicy::FIFO;
+    }
+    if (name == "random")
+    {
+        return ReplacementPolicy::Random;
+    }
+    throw std::invalid_argument("Unknown replacement policy '" + name + "' (expected lru, fifo or random).");
+}
+
+L2Cache::L2Cache(unsigned int s, unsigned int E, unsigned int b, ReplacementPolicy replacement) : num_sets(1u << s),
+                                                                                                  associativity(E),
+                                                                                                  set_bits(s),
+                                                                                                  block_bits(b),
+                                                                                                  policy(replacement),
+                                                                                                  sets(num_sets, CacheSet(E))
+{
+    if (E == 0)
+    {
+        throw std::invalid_argument("L2 associativity must be greater than 0.");
+    }
+}
+
+addr_t L2Cache::getTag(addr_t block_addr) const
+{
+    if ((set_bits + block_bits) >= 32)
+        return 0;
+    return static_cast<uint32_t>(block_addr) >> (set_bits + block_bits);
+}
+
+addr_t L2Cache::blockAddress(const CacheLine &line, unsigned int index) const
+{
+    return withAsid((addr_t(line.tag) << (set_bits + block_bits)) | (index << block_bits), line.asid);
+}
+
+CacheLine *L2Cache::find(addr_t block_addr)
+{
+    CacheSet &set = sets[getIndex(block_addr)];
+    int way = set.findLine(getTag(block_addr), asidOf(block_addr));
+    return way == -1 ? nullptr : &set.getLine(way);
+}
+
+void L2Cache::touch(CacheLine &line, cycle_t current_cycle)
+{
+    if (policy == ReplacementPolicy::LRU)
+    {
+        line.lastUsedCycle = current_cycle;
+    }
+}
+
+L2Cache::Victim L2Cache::install(addr_t block_addr, MESIState state, cycle_t current_cycle)
+{
+    unsigned int index = getIndex(block_addr);
+    CacheSet &set = sets[index];
+    Victim victim;
+
+    int way = set.findInvalidLine();
+    if (way == -1)
+    {
+        if (policy == ReplacementPolicy::Random)
+        {
+            rng_state ^= rng_state << 13;
+            rng_state ^= rng_state >> 17;
+            rng_state ^= rng_state << 5;
+            way = rng_state % associativity;
+        }
+        else
+        {
+            way = set.getLRUVictim(); // Oldest stamp: last use for LRU, fill time for FIFO
+        }
+        const CacheLine &old = set.getLine(way);
+        victim.valid = true;
+        victim.state = old.state;
+        victim.block_addr = blockAddress(old, index);
+    }
+
+    CacheLine &line = set.getLine(way);
+    line.state = state;
+    line.asid = asidOf(block_addr);
+    line.tag = static_cast<uint32_t>(getTag(block_addr));
+    line.lastUsedCycle = current_cycle;
+    return victim;
+}
+
+std::vector<addr_t> L2Cache::validBlocks() const
+{
+    std::vector<addr_t> blocks;
+    for (unsigned int index = 0; index < num_sets; ++index)
+    {
+        for (unsigned int way = 0; way < associativity; ++way)
+        {
+            const CacheLine &line = sets[index].getLine(way);
+            if (line.isValid())
+            {
+                blocks.push_back(blockAddress(line, index));
+            }
+        }
+    }
+    return blocks;
+}
+
+void L2Cache::saveState(CheckpointWriter &out) const
+{
+    out.put<uint32_t>(num_sets);
+    out.put<uint32_t>(associativity);
+    out.put(rng_state);
+    for (const CacheSet &set : sets)
+    {
+        for (unsigned int way = 0; way < associativity; ++way)
+        {
+            const CacheLine &line = set.getLine(way);
+            out.put<uint8_t>(static_cast<uint8_t>(line.state));
+            out.put(line.asid);
+            out.put(line.tag);
+            out.put(line.lastUsedCycle);
+        }
+    }
+}
+
+void L2Cache::loadState(CheckpointReader &in)
+{
+    if (in.get<uint32_t>() != num_sets || in.get<uint32_t>() != associativity)
+    {
+        throw std::runtime_error("Checkpoint L2 geometry does not match this configuration.");
+    }
+    rng_state = in.get<uint32_t>();
+    for (CacheSet &set : sets)
+    {
+        for (unsigned int way = 0; way < associativity; ++way)
+        {
+            CacheLine &line = set.getLine(way);
+            line.state = static_cast<MESIState>(in.get<uint8_t>());
+            line.asid = in.get<asid_t>();
+            line.tag = in.get<uint32_t>();
+            line.lastUsedCycle = in.get<cycle_t>();
+        }
+    }
+}
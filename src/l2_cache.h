@@ -0,0 +1,63 @@
+#ifndef L2_CACHE_H
+#define L2_CACHE_H
+
+#include <string>
+#include <vector>
+#include "defs.h"
+#include "cache_set.h"
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Victim selection for the L2 (the L1 is always LRU)
+enum class ReplacementPolicy {
+    LRU,
+    FIFO,  // Oldest fill first; hits do not refresh a line
+    Random
+};
+
+// Throws std::invalid_argument for anything other than "lru", "fifo" or "random"
+ReplacementPolicy parseReplacementPolicy(const std::string &name);
+
+// Private second-level tag store with a MESI state per block. It has no protocol logic
+// of its own: the L1 Cache in front of it drives it, and the L1+L2 pair acts as one
+// coherence agent on the bus. Blocks are the same size as in the L1.
+class L2Cache {
+public:
+    struct Victim {
+        bool valid = false;
+        addr_t block_addr = 0;
+        MESIState state = MESIState::INVALID;
+    };
+
+private:
+    unsigned int num_sets;
+    unsigned int associativity;
+    unsigned int set_bits;
+    unsigned int block_bits;
+    ReplacementPolicy policy;
+    std::vector<CacheSet> sets;
+    uint32_t rng_state = 0x2545f491; // xorshift32 state for Random
+
+    unsigned int getIndex(addr_t block_addr) const { return (block_addr >> block_bits) & (num_sets - 1); }
+    addr_t getTag(addr_t block_addr) const;
+    addr_t blockAddress(const CacheLine &line, unsigned int index) const;
+
+public:
+    L2Cache(unsigned int s, unsigned int E, unsigned int b, ReplacementPolicy replacement);
+
+    // The valid line holding block_addr, or nullptr
+    CacheLine *find(addr_t block_addr);
+    // Records a use for LRU (FIFO and Random ignore it)
+    void touch(CacheLine &line, cycle_t current_cycle);
+    // Places block_addr in the given state and returns the valid line it displaced, if any
+    Victim install(addr_t block_addr, MESIState state, cycle_t current_cycle);
+
+    // Addresses of all valid blocks (used to rebuild a snoop filter)
+    std::vector<addr_t> validBlocks() const;
+
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
+
+#endif
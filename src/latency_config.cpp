@@ -0,0 +1,130 @@
+#include "latency_config.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+void LatencyConfig::loadFile(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::runtime_error("Could not open latency config: " + path);
+    }
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line))
+    {
+        line_no++;
+        line = line.substr(0, line.find('#'));
+        size_t eq = line.find('=');
+        std::istringstream key_stream(line.substr(0, eq));
+        std::string key;
+        if (!(key_stream >> key))
+        {
+            continue; // Blank or comment-only line
+        }
+
+        std::string where = path + ":" + std::to_string(line_no);
+        if (eq == std::string::npos)
+        {
+            throw std::runtime_error(where + ": expected 'key = value'");
+        }
+        std::istringstream value_stream(line.substr(eq + 1));
+        std::string token;
+        std::string trailing;
+        if (!(value_stream >> token) || (value_stream >> trailing))
+        {
+            throw std::runtime_error(where + ": expected a single value for '" + key + "'");
+        }
+
+        // The two enumerated settings take words, everything else a cycle/byte count
+        if (key == "memory_model")
+        {
+            if (token == "flat")
+                memory_model = MemoryModel::Flat;
+            else if (token == "dram")
+                memory_model = MemoryModel::Dram;
+            else
+                throw std::runtime_error(where + ": memory_model must be 'flat' or 'dram'");
+            continue;
+        }
+        if (key == "dram_scheduler")
+        {
+            if (token == "fcfs")
+                dram_scheduler = DramScheduler::FCFS;
+            else if (token == "frfcfs")
+                dram_scheduler = DramScheduler::FRFCFS;
+            else
+                throw std::runtime_error(where + ": dram_scheduler must be 'fcfs' or 'frfcfs'");
+            continue;
+        }
+
+        if (token.find_first_not_of("0123456789") != std::string::npos || token.size() > 18)
+        {
+            throw std::runtime_error(where + ": value for '" + key + "' must be a non-negative integer");
+        }
+        unsigned long long value = std::stoull(token);
+
+        if (key == "hit_latency")
+            hit_latency = value;
+        else if (key == "mem_latency")
+            mem_latency = value;
+        else if (key == "writeback_latency")
+            writeback_latency = value;
+        else if (key == "c2c_cycles_per_word")
+            c2c_cycles_per_word = value;
+        else if (key == "upgrade_latency")
+            upgrade_latency = value;
+        else if (key == "bus_width_bytes")
+            bus_width_bytes = static_cast<unsigned int>(value);
+        else if (key == "l2_hit_latency")
+            l2_hit_latency = value;
+        else if (key == "hop_latency")
+            hop_latency = value;
+        else if (key == "decompression_latency")
+            decompression_latency = value;
+        else if (key == "way_mispredict_penalty")
+            way_mispredict_penalty = value;
+        else if (key == "victim_hit_latency")
+            victim_hit_latency = value;
+        else if (key == "dram_banks")
+            dram_banks = static_cast<unsigned int>(value);
+        else if (key == "dram_row_bytes")
+            dram_row_bytes = static_cast<unsigned int>(value);
+        else if (key == "dram_row_hit_latency")
+            dram_row_hit_latency = value;
+        else if (key == "dram_row_miss_latency")
+            dram_row_miss_latency = value;
+        else if (key == "dram_queue_depth")
+            dram_queue_depth = static_cast<unsigned int>(value);
+        else if (key == "dram_write_post_latency")
+            dram_write_post_latency = value;
+        else
+            throw std::runtime_error(where + ": unknown latency key '" + key + "'");
+    }
+}
+
+void LatencyConfig::validate() const
+{
+    if (hit_latency == 0)
+    {
+        throw std::invalid_argument("hit_latency must be at least 1 cycle.");
+    }
+    if (bus_width_bytes == 0)
+    {
+        throw std::invalid_argument("bus_width_bytes must be greater than 0.");
+    }
+    if (memory_model == MemoryModel::Dram)
+    {
+        auto is_pow2 = [](unsigned int v) { return v != 0 && (v & (v - 1)) == 0; };
+        if (!is_pow2(dram_banks) || !is_pow2(dram_row_bytes))
+        {
+            throw std::invalid_argument("dram_banks and dram_row_bytes must be powers of two.");
+        }
+        if (dram_queue_depth == 0)
+        {
+            throw std::invalid_argument("dram_queue_depth must be greater than 0.");
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef LATENCY_CONFIG_H
+#define LATENCY_CONFIG_H
+
+#include <string>
+#include "defs.h"
+
+// Main memory behind the bus: a fixed latency per access, or a banked DRAM model
+enum class MemoryModel {
+    Flat,
+    Dram
+};
+
+// Order in which the DRAM controller serves queued requests to a bank
+enum class DramScheduler {
+    FCFS,  // Strictly oldest first
+    FRFCFS // Row-buffer hits first, then oldest
+};
+
+// Timing parameters. Defaults reproduce the constants in defs.h; loadFile() overrides
+// them from a "key = value" file (keys are the field names below) so the model can be
+// calibrated without recompiling.
+struct LatencyConfig {
+    cycle_t hit_latency = L1_HIT_CYCLES;                           // Cycles a core spends on an L1 hit
+    cycle_t mem_latency = MEM_ACCESS_CYCLES;                       // BusRd/BusRdX served by memory
+    cycle_t writeback_latency = MEM_ACCESS_CYCLES;                 // Dirty block written back to memory
+    cycle_t c2c_cycles_per_word = C2C_BLOCK_TRANSFER_CYCLE_FACTOR; // Cache-to-cache cost per bus word
+    cycle_t upgrade_latency = 1;                                   // BusUpgr invalidation broadcast
+    unsigned int bus_width_bytes = 4;                              // Bytes moved per bus word
+    cycle_t l2_hit_latency = 10;                                   // L1 miss served by the private L2 (-2)
+    cycle_t hop_latency = 1;                                       // Per ring hop or crossbar traversal (-B)
+    cycle_t decompression_latency = 2;                             // Extra cycles for a read hit on a compressed line (-z)
+    cycle_t way_mispredict_penalty = 1;                            // Per extra way probed before a hit (-W)
+    cycle_t victim_hit_latency = 1;                                // Extra cycles for an L1 miss served by the victim cache (-V)
+
+    // memory_model = flat uses mem_latency/writeback_latency. memory_model = dram replaces
+    // them with a controller whose cost depends on row-buffer locality.
+    MemoryModel memory_model = MemoryModel::Flat;
+    DramScheduler dram_scheduler = DramScheduler::FRFCFS;
+    unsigned int dram_banks = 8;
+    unsigned int dram_row_bytes = 2048;       // Row buffer size; consecutive rows map to consecutive banks
+    cycle_t dram_row_hit_latency = 40;        // Column access to the open row
+    cycle_t dram_row_miss_latency = MEM_ACCESS_CYCLES; // Precharge + activate + column access
+    unsigned int dram_queue_depth = 16;       // Posted writebacks the controller can hold
+    cycle_t dram_write_post_latency = 8;      // Bus time to hand a writeback to the controller
+
+    // Blank lines and '#' comments are ignored. Throws std::runtime_error on an
+    // unreadable file, an unknown key or a malformed value.
+    void loadFile(const std::string &path);
+    // Throws std::invalid_argument if a value is out of range
+    void validate() const;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include "event_log.h"
+
+// Compares two event logs written with -R and reports the first record where they differ.
+// Exit status: 0 identical, 1 divergent, 2 usage or I/O error.
+
+namespace
+{
+const char *kindName(uint8_t kind)
+{
+    switch (static_cast<EventKind>(kind))
+    {
+    case EventKind::BusGrant:
+        return "BusGrant";
+    case EventKind::Snoop:
+        return "Snoop";
+    case EventKind::Fill:
+        return "Fill";
+    case EventKind::Upgrade:
+        return "Upgrade";
+    case EventKind::Eviction:
+        return "Eviction";
+    }
+    return "Unknown";
+}
+
+void printRecord(const std::string &label, const EventRecord &record)
+{
+    std::cout << "  " << label << ": cycle " << record.cycle << ", core " << static_cast<int>(record.core)
+              << ", block 0x" << std::hex << record.block_addr << std::dec << ", " << kindName(record.kind)
+              << " (detail 0x" << std::hex << static_cast<int>(record.detail) << ", flags 0x"
+              << static_cast<int>(record.flags) << std::dec << ")" << std::endl;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <reference.log> <candidate.log>" << std::endl;
+        return 2;
+    }
+
+    try
+    {
+        EventLogReader reference(argv[1]);
+        EventLogReader candidate(argv[2]);
+        EventRecord a, b;
+        uint64_t index = 0;
+        uint64_t hash = EVENT_HASH_SEED;
+
+        while (true)
+        {
+            bool has_a = reference.next(a);
+            bool has_b = candidate.next(b);
+            if (!has_a && !has_b)
+            {
+                std::cout << "Logs identical: " << index << " events, hash 0x" << std::hex << std::setw(16)
+                          << std::setfill('0') << hash << std::dec << std::endl;
+                return 0;
+            }
+            if (!has_a || !has_b)
+            {
+                std::cout << "Logs diverge at event " << index << ": " << (has_a ? argv[2] : argv[1])
+                          << " ends here" << std::endl;
+                printRecord(has_a ? argv[1] : argv[2], has_a ? a : b);
+                return 1;
+            }
+            if (a.cycle != b.cycle || a.block_addr != b.block_addr || a.kind != b.kind || a.core != b.core ||
+                a.detail != b.detail || a.flags != b.flags)
+            {
+                std::cout << "Logs diverge at event " << index << " (cycle " << std::min(a.cycle, b.cycle) << ")"
+                          << std::endl;
+                printRecord(argv[1], a);
+                printRecord(argv[2], b);
+                return 1;
+            }
+            hash = mixEventHash(hash, a);
+            index++;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+}
@@ -0,0 +1,176 @@
+#include "memory.h"
+#include "stats.h"
+#include "checkpoint.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+std::unique_ptr<MemoryBackend> MemoryBackend::create(const LatencyConfig &latency, Stats *statistics)
+{
+    if (latency.memory_model == MemoryModel::Dram)
+    {
+        return std::make_unique<DramMemory>(latency, statistics);
+    }
+    return nullptr;
+}
+
+DramMemory::DramMemory(const LatencyConfig &latency, Stats *statistics) : scheduler(latency.dram_scheduler),
+                                                                          row_hit_latency(latency.dram_row_hit_latency),
+                                                                          row_miss_latency(latency.dram_row_miss_latency),
+                                                                          write_post_latency(latency.dram_write_post_latency),
+                                                                          queue_depth(latency.dram_queue_depth),
+                                                                          row_bits(0),
+                                                                          bank_mask(latency.dram_banks - 1),
+                                                                          banks(latency.dram_banks),
+                                                                          stats(statistics)
+{
+    if (stats == nullptr)
+    {
+        throw std::invalid_argument("DramMemory requires a valid Stats pointer.");
+    }
+    while ((1u << row_bits) < latency.dram_row_bytes)
+    {
+        row_bits++;
+    }
+    stats->dram_enabled = true;
+}
+
+bool DramMemory::isRowHit(addr_t addr) const
+{
+    const Bank &bank = banks[bankOf(addr)];
+    return bank.row_open && bank.open_row == rowOf(addr);
+}
+
+cycle_t DramMemory::serve(addr_t addr, cycle_t start)
+{
+    Bank &bank = banks[bankOf(addr)];
+    bool hit = isRowHit(addr);
+    stats->recordDramRowAccess(hit);
+
+    start = std::max(start, bank.ready_at);
+    bank.row_open = true;
+    bank.open_row = rowOf(addr);
+    bank.ready_at = start + (hit ? row_hit_latency : row_miss_latency);
+    return bank.ready_at;
+}
+
+int DramMemory::pickWrite(int bank, cycle_t before) const
+{
+    int oldest = -1;
+    for (size_t i = 0; i < write_queue.size(); ++i)
+    {
+        const QueuedWrite &write = write_queue[i];
+        unsigned int write_bank = bankOf(write.block_addr);
+        if (bank >= 0 && write_bank != static_cast<unsigned int>(bank))
+        {
+            continue;
+        }
+        if (std::max(banks[write_bank].ready_at, write.arrival) >= before)
+        {
+            continue;
+        }
+        if (scheduler == DramScheduler::FRFCFS && isRowHit(write.block_addr))
+        {
+            return static_cast<int>(i); // First ready: oldest row hit
+        }
+        if (oldest < 0)
+        {
+            oldest = static_cast<int>(i);
+            if (scheduler == DramScheduler::FCFS)
+            {
+                break; // Queue is kept oldest first
+            }
+        }
+    }
+    return oldest;
+}
+
+cycle_t DramMemory::issueWrite(size_t index)
+{
+    QueuedWrite write = write_queue[index];
+    write_queue.erase(write_queue.begin() + index);
+
+    cycle_t start = std::max(banks[bankOf(write.block_addr)].ready_at, write.arrival);
+    serve(write.block_addr, start);
+    return start;
+}
+
+void DramMemory::drainUntil(cycle_t now)
+{
+    int next;
+    while ((next = pickWrite(-1, now)) >= 0)
+    {
+        issueWrite(next);
+    }
+}
+
+cycle_t DramMemory::access(addr_t block_addr, bool is_write, cycle_t current_cycle)
+{
+    drainUntil(current_cycle);
+
+    if (is_write)
+    {
+        // Posted: the bus only waits if the queue has no free slot
+        cycle_t slot_free = current_cycle;
+        bool was_full = write_queue.size() >= queue_depth;
+        while (write_queue.size() >= queue_depth)
+        {
+            int next = pickWrite(-1, std::numeric_limits<cycle_t>::max());
+            slot_free = std::max(slot_free, issueWrite(next));
+        }
+        write_queue.push_back({block_addr, slot_free});
+        stats->recordDramWrite(was_full);
+        return (slot_free - current_cycle) + write_post_latency;
+    }
+
+    // Queued writes to the same bank go first, unless FR-FCFS lets a row hit jump ahead
+    int bank = static_cast<int>(bankOf(block_addr));
+    while (!(scheduler == DramScheduler::FRFCFS && isRowHit(block_addr)))
+    {
+        int next = pickWrite(bank, std::numeric_limits<cycle_t>::max());
+        if (next < 0)
+        {
+            break;
+        }
+        issueWrite(next);
+    }
+
+    cycle_t latency = serve(block_addr, current_cycle) - current_cycle;
+    stats->recordDramRead(latency);
+    return latency;
+}
+
+void DramMemory::saveState(CheckpointWriter &out) const
+{
+    for (const Bank &bank : banks)
+    {
+        out.put<uint8_t>(bank.row_open);
+        out.put(bank.open_row);
+        out.put(bank.ready_at);
+    }
+    out.put<uint64_t>(write_queue.size());
+    for (const QueuedWrite &write : write_queue)
+    {
+        out.put(write.block_addr);
+        out.put(write.arrival);
+    }
+}
+
+void DramMemory::loadState(CheckpointReader &in)
+{
+    for (Bank &bank : banks)
+    {
+        bank.row_open = in.get<uint8_t>() != 0;
+        bank.open_row = in.get<addr_t>();
+        bank.ready_at = in.get<cycle_t>();
+    }
+    write_queue.clear();
+    uint64_t count = in.get<uint64_t>();
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        QueuedWrite write;
+        write.block_addr = in.get<addr_t>();
+        write.arrival = in.get<cycle_t>();
+        write_queue.push_back(write);
+    }
+}
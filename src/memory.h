@@ -0,0 +1,81 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include "defs.h"
+#include "latency_config.h"
+
+class Stats;
+class CheckpointWriter;
+class CheckpointReader;
+
+// Main memory as seen by the Bus. access() returns how many cycles the bus
+// transaction that reaches memory lasts. The flat model has no backend object:
+// Bus takes its fixed costs straight from the latency table.
+class MemoryBackend {
+public:
+    virtual ~MemoryBackend() = default;
+
+    virtual cycle_t access(addr_t block_addr, bool is_write, cycle_t current_cycle) = 0;
+
+    virtual void saveState(CheckpointWriter &out) const = 0;
+    virtual void loadState(CheckpointReader &in) = 0;
+
+    // Builds the backend selected by latency.memory_model (nullptr for the flat model)
+    static std::unique_ptr<MemoryBackend> create(const LatencyConfig &latency, Stats *statistics);
+};
+
+// Banked DRAM with one row buffer per bank. Reads (BusRd/BusRdX fills) hold the bus
+// until their data returns. Writebacks are posted into a finite queue and drained
+// in the background; the bus only waits for them when the queue is full. Banks work
+// in parallel; requests to the same bank are ordered by the scheduling policy.
+class DramMemory : public MemoryBackend {
+private:
+    struct Bank {
+        bool row_open = false;
+        addr_t open_row = 0;
+        cycle_t ready_at = 0; // Cycle the bank finishes its current request
+    };
+    struct QueuedWrite {
+        addr_t block_addr;
+        cycle_t arrival;
+    };
+
+    DramScheduler scheduler;
+    cycle_t row_hit_latency;
+    cycle_t row_miss_latency;
+    cycle_t write_post_latency;
+    size_t queue_depth;
+    unsigned int row_bits;  // log2(row size)
+    unsigned int bank_mask; // banks - 1
+
+    std::vector<Bank> banks;
+    std::deque<QueuedWrite> write_queue; // Oldest first
+    Stats *stats;
+
+    unsigned int bankOf(addr_t addr) const { return (addr >> row_bits) & bank_mask; }
+    addr_t rowOf(addr_t addr) const { return addr >> row_bits; } // Unique across banks
+    bool isRowHit(addr_t addr) const;
+
+    // Runs one request on its bank no earlier than start; returns its completion cycle
+    cycle_t serve(addr_t addr, cycle_t start);
+    // Picks the queued write the scheduler would issue next among those on bank (any bank
+    // if bank < 0) that could start before the given cycle. Returns -1 if there is none.
+    int pickWrite(int bank, cycle_t before) const;
+    // Removes write_queue[index] and serves it; returns the cycle it started
+    cycle_t issueWrite(size_t index);
+    // Issues queued writes whose bank would have started them before now
+    void drainUntil(cycle_t now);
+
+public:
+    DramMemory(const LatencyConfig &latency, Stats *statistics);
+
+    cycle_t access(addr_t block_addr, bool is_write, cycle_t current_cycle) override;
+
+    void saveState(CheckpointWriter &out) const override;
+    void loadState(CheckpointReader &in) override;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "page_map.h"
+#include "checkpoint.h"
+#include <stdexcept>
+
+PageMapPolicy parsePageMapPolicy(const std::string &name)
+{
+    if (name == "none")
+    {
+        return PageMapPolicy::None;
+    }
+    if (name == "random")
+    {
+        return PageMapPolicy::Random;
+    }
+    if (name == "first-touch")
+    {
+        return PageMapPolicy::FirstTouch;
+    }
+    throw std::invalid_argument("Unknown page mapping '" + name + "' (expected none, random or first-touch).");
+}
+
+PageMap::PageMap(PageMapPolicy map_policy, unsigned int page_offset_bits, uint64_t seed) : policy(map_policy),
+                                                                                           page_bits(page_offset_bits),
+                                                                                           frame_count(uint64_t(1) << (32 - page_offset_bits)),
+                                                                                           rng_state(seed ? seed : 1)
+{
+    if (page_offset_bits >= 32)
+    {
+        throw std::invalid_argument("Page offset bits must be below 32.");
+    }
+}
+
+addr_t PageMap::allocateFrame()
+{
+    if (frames.size() >= frame_count)
+    {
+        throw std::runtime_error("Page mapping ran out of physical frames.");
+    }
+    if (policy == PageMapPolicy::FirstTouch)
+    {
+        return next_frame++;
+    }
+    addr_t frame;
+    do
+    {
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 7;
+        rng_state ^= rng_state << 17;
+        frame = rng_state % frame_count;
+    } while (!used_frames.insert(frame).second);
+    return frame;
+}
+
+addr_t PageMap::translate(addr_t address)
+{
+    if (policy == PageMapPolicy::None)
+    {
+        return address;
+    }
+    addr_t page = address >> page_bits;
+    auto it = frames.find(page);
+    if (it == frames.end())
+    {
+        it = frames.emplace(page, allocateFrame()).first;
+    }
+    return (it->second << page_bits) | (address & ((addr_t(1) << page_bits) - 1));
+}
+
+void PageMap::saveState(CheckpointWriter &out) const
+{
+    out.put<uint8_t>(static_cast<uint8_t>(policy));
+    out.put(next_frame);
+    out.put(rng_state);
+    out.put<uint64_t>(frames.size());
+    for (const auto &[page, frame] : frames)
+    {
+        out.put(page);
+        out.put(frame);
+    }
+}
+
+void PageMap::loadState(CheckpointReader &in)
+{
+    if (in.get<uint8_t>() != static_cast<uint8_t>(policy))
+    {
+        throw std::runtime_error("Checkpoint was taken with a different page mapping.");
+    }
+    next_frame = in.get<addr_t>();
+    rng_state = in.get<uint64_t>();
+    frames.clear();
+    used_frames.clear();
+    uint64_t count = in.get<uint64_t>();
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        addr_t page = in.get<addr_t>();
+        addr_t frame = in.get<addr_t>();
+        frames[page] = frame;
+        if (policy == PageMapPolicy::Random)
+        {
+            used_frames.insert(frame);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef PAGE_MAP_H
+#define PAGE_MAP_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "defs.h"
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// How virtual pages get physical frames
+enum class PageMapPolicy {
+    None,       // No translation: the ASID-tagged virtual address is used as is
+    Random,     // Each new page gets a random free frame
+    FirstTouch  // Frames are handed out in order of first touch
+};
+
+// Throws std::invalid_argument for anything other than "none", "random" or "first-touch"
+PageMapPolicy parsePageMapPolicy(const std::string &name);
+
+// Shared page table for all cores, translating (ASID, virtual page) to a frame in a 32-bit
+// physical space. Translated addresses carry no ASID: two processes only share a block
+// if they map the same frame, which never happens, so their data cannot alias.
+class PageMap {
+private:
+    PageMapPolicy policy;
+    unsigned int page_bits;
+    uint64_t frame_count;
+    std::unordered_map<addr_t, addr_t> frames; // ASID-tagged virtual page -> frame
+    std::unordered_set<addr_t> used_frames;    // Random: frames already handed out
+    addr_t next_frame = 0;                     // FirstTouch: next frame to hand out
+    uint64_t rng_state;                        // xorshift64 state for Random
+
+    addr_t allocateFrame();
+
+public:
+    PageMap(PageMapPolicy map_policy, unsigned int page_offset_bits, uint64_t seed);
+
+    // Maps the page on first use. Throws std::runtime_error when physical memory is full.
+    addr_t translate(addr_t address);
+    size_t mappedPages() const { return frames.size(); }
+
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
+
+#endif
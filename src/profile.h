@@ -0,0 +1,101 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <cstdint>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Host-time self-profiling, compiled in only with -DL1SIM_PROFILE (make PROFILE=1).
+// Without it L1SIM_PROFILE_ZONE expands to nothing, so a normal build pays no cost.
+//
+// Each zone's time is exclusive: entering a zone charges the time so far to the zone
+// being left, and leaving charges the zone's own time, so the zones add up to the
+// whole profiled interval. Time outside every zone goes to Other.
+
+enum class ProfileZone {
+    TraceRead,        // Core::readAndParseNextAccess
+    CacheAccess,      // Cache::access (hit path and miss handling)
+    Arbitration,      // Bus::arbitrate
+    Snooping,         // Bus::processSnooping
+    TransactionStart, // Bus::startTransaction (latency, memory model, traffic)
+    Other             // Core logic, fills, the cycle loop
+};
+const int PROFILE_ZONE_COUNT = static_cast<int>(ProfileZone::Other) + 1;
+
+inline const char *profileZoneName(int zone)
+{
+    static const char *names[PROFILE_ZONE_COUNT] = {"Trace Reading", "Cache Access", "Bus Arbitration",
+                                                    "Snooping", "Transaction Start", "Other"};
+    return names[zone];
+}
+
+// Per-thread totals, so simulators on different threads (l1batch) do not mix
+struct HostProfile {
+    uint64_t ticks[PROFILE_ZONE_COUNT] = {};
+    uint64_t calls[PROFILE_ZONE_COUNT] = {};
+};
+
+#ifdef L1SIM_PROFILE
+
+inline uint64_t profileTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+inline thread_local HostProfile host_profile;
+inline thread_local ProfileZone profile_zone = ProfileZone::Other;
+inline thread_local uint64_t profile_mark = 0;
+
+// Starts charging this thread's time to Other from now
+inline void profileStart()
+{
+    profile_zone = ProfileZone::Other;
+    profile_mark = profileTicks();
+}
+
+// Charges the time since the last zone change to the current zone
+inline void profileFlush()
+{
+    uint64_t now = profileTicks();
+    host_profile.ticks[static_cast<int>(profile_zone)] += now - profile_mark;
+    profile_mark = now;
+}
+
+class ProfileScope {
+private:
+    ProfileZone parent;
+
+public:
+    explicit ProfileScope(ProfileZone zone) : parent(profile_zone)
+    {
+        profileFlush();
+        profile_zone = zone;
+        host_profile.calls[static_cast<int>(zone)]++;
+    }
+    ~ProfileScope()
+    {
+        profileFlush();
+        profile_zone = parent;
+    }
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+#define L1SIM_PROFILE_ZONE(zone) ProfileScope l1sim_profile_scope(ProfileZone::zone)
+
+#else
+
+#define L1SIM_PROFILE_ZONE(zone) \
+    do                           \
+    {                            \
+    } while (0)
+
+#endif
+
+#endif
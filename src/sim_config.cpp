@@ -0,0 +1,283 @@
+#include "sim_config.h"
+#include "stats_export.h"
+#include <stdexcept>
+#include <sstream>
+#include <vector>
+
+void SimConfig::validate() const
+{
+    if (E == 0)
+    {
+        throw std::invalid_argument("Associativity (-E) must be greater than 0.");
+    }
+    if (b < 2)
+    { // Need at least 2 bits for 4-byte offset within block
+        throw std::invalid_argument("Block offset bits (-b) must be at least 2 (for 4-byte block minimum).");
+    }
+    if (s >= 32 || b >= 32)
+    {
+        throw std::invalid_argument("Set index bits (-s) and block offset bits (-b) must each be below 32.");
+    }
+    if (checkpoint_interval > 0 && checkpoint_path.empty())
+    {
+        throw std::invalid_argument("Checkpoint interval (-K) needs a checkpoint file (-k).");
+    }
+    if (l2_E > 0 && l2_s + b >= 32)
+    {
+        throw std::invalid_argument("L2 set index bits plus block offset bits must be below 32.");
+    }
+    if (fairness_report && (manifest_path.empty() && (trace_base_name.empty() || trace_base_name == "-" ||
+                                                      trace_base_name.rfind("unix:", 0) == 0)))
+    {
+        throw std::invalid_argument("The fairness report (-f) reruns each trace alone, so it needs trace files (-t or -m).");
+    }
+    if (sectors == 0 || sectors > 32 || (sectors & (sectors - 1)) != 0 || sectors > (1u << b) / 4)
+    {
+        throw std::invalid_argument("Sectors per block (-x) must be a power of two, at most 32 and at most one per 4-byte word.");
+    }
+    if (sectors > 1 && l2_E > 0)
+    {
+        throw std::invalid_argument("Sectored L1 lines (-x) cannot be combined with a private L2 (-2).");
+    }
+    if (compression != CompressionModel::None && (compression_tags == 0 || compression_tags > 8))
+    {
+        throw std::invalid_argument("Compressed caches (-z) take 1 to 8 tags per way.");
+    }
+    if (compression != CompressionModel::None && sectors > 1)
+    {
+        throw std::invalid_argument("Compressed lines (-z) cannot be combined with sectored lines (-x).");
+    }
+    if (victim_cache_entries > 64)
+    {
+        throw std::invalid_argument("A victim cache (-V) holds at most 64 entries.");
+    }
+    if (victim_cache_entries > 0 && (l2_E > 0 || sectors > 1))
+    {
+        throw std::invalid_argument("A victim cache (-V) cannot be combined with a private L2 (-2) or sectored lines (-x).");
+    }
+    if (!stats_export_path.empty())
+    {
+        checkStatsExportPath(stats_export_path);
+    }
+    if (stats_export_interval > 0 && stats_export_path.empty())
+    {
+        throw std::invalid_argument("A stats export interval needs a stats export file (-O).");
+    }
+    if (page_map != PageMapPolicy::None && (page_bits < b || page_bits >= 32))
+    {
+        throw std::invalid_argument("Page offset bits must be at least the block offset bits (-b) and below 32.");
+    }
+    latency.validate();
+}
+
+void SimConfig::parseInterconnectSpec(const std::string &spec)
+{
+    size_t colon = spec.find(':');
+    std::string count = spec.substr(0, colon);
+    try
+    {
+        size_t used = 0;
+        unsigned long value = std::stoul(count, &used);
+        if (used != count.size() || value == 0 || value > 64)
+        {
+            throw std::invalid_argument("");
+        }
+        bus_slices = static_cast<unsigned int>(value);
+    }
+    catch (const std::exception &)
+    {
+        throw std::invalid_argument("Bus slice count must be an integer from 1 to 64, got '" + spec + "'.");
+    }
+    if (colon != std::string::npos)
+    {
+        topology = parseInterconnectTopology(spec.substr(colon + 1));
+    }
+}
+
+void SimConfig::parseStatsExportSpec(const std::string &spec)
+{
+    size_t colon = spec.rfind(':');
+    std::string interval = (colon == std::string::npos) ? "" : spec.substr(colon + 1);
+    if (interval.empty() || interval.find_first_not_of("0123456789") != std::string::npos || interval.size() > 18)
+    {
+        // No interval, or a colon that belongs to the file name
+        stats_export_path = spec;
+        stats_export_interval = 0;
+        return;
+    }
+    stats_export_path = spec.substr(0, colon);
+    stats_export_interval = std::stoull(interval);
+}
+
+void SimConfig::parseCompressionSpec(const std::string &spec)
+{
+    size_t colon = spec.find(':');
+    compression = parseCompressionModel(spec.substr(0, colon));
+    if (colon == std::string::npos)
+    {
+        return;
+    }
+    std::string tags = spec.substr(colon + 1);
+    try
+    {
+        size_t used = 0;
+        unsigned long value = std::stoul(tags, &used);
+        if (used != tags.size() || value == 0 || value > 8)
+        {
+            throw std::invalid_argument("");
+        }
+        compression_tags = static_cast<unsigned int>(value);
+    }
+    catch (const std::exception &)
+    {
+        throw std::invalid_argument("Compression tags per way must be an integer from 1 to 8, got '" + spec + "'.");
+    }
+}
+
+void SimConfig::parseWayPredictionSpec(const std::string &spec)
+{
+    size_t colon = spec.find(':');
+    way_prediction = parseWayPrediction(spec.substr(0, colon));
+    if (colon == std::string::npos)
+    {
+        return;
+    }
+    std::string bits = spec.substr(colon + 1);
+    try
+    {
+        size_t used = 0;
+        unsigned long value = std::stoul(bits, &used);
+        if (used != bits.size() || value == 0 || value > 16 || way_prediction != WayPrediction::PartialTag)
+        {
+            throw std::invalid_argument("");
+        }
+        partial_tag_bits = static_cast<unsigned int>(value);
+    }
+    catch (const std::exception &)
+    {
+        throw std::invalid_argument("Way prediction spec must be none, mru or partial[:<bits>] with 1 to 16 bits, got '" + spec + "'.");
+    }
+}
+
+void SimConfig::parseArbitrationSpec(const std::string &spec)
+{
+    std::vector<std::string> fields;
+    std::istringstream in(spec);
+    std::string field;
+    while (std::getline(in, field, ':'))
+    {
+        fields.push_back(field);
+    }
+    if (fields.empty())
+    {
+        throw std::invalid_argument("Arbitration spec must be <policy>[:<c0>,<c1>,...][:demand-first], got '" + spec + "'.");
+    }
+    arbitration = parseArbitrationPolicy(fields[0]);
+    for (size_t i = 1; i < fields.size(); ++i)
+    {
+        if (fields[i] == "demand-first")
+        {
+            demand_first = true;
+            continue;
+        }
+        if (arbitration != ArbitrationPolicy::FixedPriority && arbitration != ArbitrationPolicy::WeightedFair)
+        {
+            throw std::invalid_argument("Only the priority and weighted policies take a per-core list, got '" + spec + "'.");
+        }
+        std::vector<unsigned int> values;
+        std::istringstream list(fields[i]);
+        std::string item;
+        while (std::getline(list, item, ','))
+        {
+            try
+            {
+                size_t used = 0;
+                unsigned long value = std::stoul(item, &used);
+                if (used != item.size() || value > UINT16_MAX)
+                {
+                    throw std::invalid_argument("");
+                }
+                values.push_back(static_cast<unsigned int>(value));
+            }
+            catch (const std::exception &)
+            {
+                throw std::invalid_argument("Arbitration list entries must be small non-negative integers, got '" + spec + "'.");
+            }
+        }
+        if (arbitration == ArbitrationPolicy::FixedPriority)
+        {
+            arbitration_order.assign(values.begin(), values.end());
+        }
+        else
+        {
+            arbitration_weights = values;
+        }
+    }
+}
+
+void SimConfig::parsePageMapSpec(const std::string &spec)
+{
+    size_t colon = spec.find(':');
+    page_map = parsePageMapPolicy(spec.substr(0, colon));
+    if (colon == std::string::npos)
+    {
+        return;
+    }
+    std::string bits = spec.substr(colon + 1);
+    try
+    {
+        size_t used = 0;
+        unsigned long value = std::stoul(bits, &used);
+        if (used != bits.size() || value >= 32)
+        {
+            throw std::invalid_argument("");
+        }
+        page_bits = static_cast<unsigned int>(value);
+    }
+    catch (const std::exception &)
+    {
+        throw std::invalid_argument("Page offset bits must be an integer below 32, got '" + spec + "'.");
+    }
+}
+
+void SimConfig::parseL2Spec(const std::string &spec)
+{
+    std::vector<std::string> fields;
+    std::istringstream in(spec);
+    std::string field;
+    while (std::getline(in, field, ':'))
+    {
+        fields.push_back(field);
+    }
+    if (fields.size() < 2 || fields.size() > 4)
+    {
+        throw std::invalid_argument("L2 spec must be <s>:<E>[:policy][:inclusion], got '" + spec + "'.");
+    }
+    try
+    {
+        size_t used_s = 0, used_E = 0;
+        unsigned long s_value = std::stoul(fields[0], &used_s);
+        unsigned long E_value = std::stoul(fields[1], &used_E);
+        if (used_s != fields[0].size() || used_E != fields[1].size() || s_value >= 32 || E_value == 0)
+        {
+            throw std::invalid_argument("");
+        }
+        l2_s = static_cast<unsigned int>(s_value);
+        l2_E = static_cast<unsigned int>(E_value);
+    }
+    catch (const std::exception &)
+    {
+        throw std::invalid_argument("L2 set bits and associativity must be integers (s < 32, E > 0), got '" + spec + "'.");
+    }
+    for (size_t i = 2; i < fields.size(); ++i)
+    {
+        if (fields[i] == "inclusive" || fields[i] == "noninclusive")
+        {
+            l2_inclusive = (fields[i] == "inclusive");
+        }
+        else
+        {
+            l2_replacement = parseReplacementPolicy(fields[i]);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef SIM_CONFIG_H
+#define SIM_CONFIG_H
+
+#include <string>
+#include <vector>
+#include "defs.h"
+#include "latency_config.h"
+#include "snoop_filter.h"
+#include "l2_cache.h"
+#include "page_map.h"
+#include "arbitration.h"
+#include "interconnect.h"
+#include "compression.h"
+#include "insertion_policy.h"
+#include "way_prediction.h"
+
+// Everything needed to build a Simulator. main.cpp fills this from the command line;
+// embedding tools fill it directly.
+struct SimConfig {
+    // Cache geometry, same meaning as -s/-E/-b
+    unsigned int s = 6;
+    unsigned int E = 2;
+    unsigned int b = 5;
+
+    // Cores read <trace_base_name>_procN.trace (a file, a named FIFO, or a Unix socket
+    // if the name starts with "unix:"). "-" demultiplexes one binary stream on stdin.
+    // Leave empty to feed every core through Simulator::pushAccess instead.
+    std::string trace_base_name;
+    // Alternatively, a manifest mapping trace files onto cores (see trace_manifest.h);
+    // takes precedence over trace_base_name
+    std::string manifest_path;
+    std::string output_file;
+
+    std::string checkpoint_path;     // Empty = no checkpoints
+    cycle_t checkpoint_interval = 0; // Cycles between checkpoints, 0 = only on SIGUSR1
+    std::string restore_path;        // Resume from this snapshot if non-empty
+
+    LatencyConfig latency;
+
+    // Per-core writeback buffer entries (0 = dirty victims queue a Writeback ahead of the miss)
+    unsigned int writeback_buffer_entries = 0;
+    // Per-core TSO store buffer entries (0 = writes stall the core until they complete)
+    unsigned int store_buffer_entries = 0;
+    // Sectors per L1 block, each with its own valid and dirty bits (1 = unsectored)
+    unsigned int sectors = 1;
+    // Optional L1 compression: compression_tags times E tags per set share E blocks' worth
+    // of data, with block sizes from the model
+    CompressionModel compression = CompressionModel::None;
+    unsigned int compression_tags = 2;
+    uint64_t compression_seed = 0x2545f4914f6cdd1dull; // Block sizes under the bdi model
+    // Sets compression and compression_tags from "<model>[:<tags>]" (the -z option).
+    // Throws std::invalid_argument on a malformed spec.
+    void parseCompressionSpec(const std::string &spec);
+    // Where L1 fills enter the recency order; anything but lru inserts predicted-dead blocks
+    // at the LRU position
+    InsertionPolicy insertion = InsertionPolicy::LRU;
+    // L1 way prediction, with the partial tag width for the partial-tag predictor
+    WayPrediction way_prediction = WayPrediction::None;
+    unsigned int partial_tag_bits = 4;
+    // Sets the fields above from "<predictor>[:<bits>]" (the -W option).
+    // Throws std::invalid_argument on a malformed spec.
+    void parseWayPredictionSpec(const std::string &spec);
+    // Per-core victim cache entries (0 = none): a fully associative buffer of L1 victims
+    unsigned int victim_cache_entries = 0;
+    // Screens snoops so caches that cannot hold the block skip the tag lookup
+    SnoopFilterKind snoop_filter = SnoopFilterKind::None;
+
+    std::string event_log_path; // Non-empty = write a replay event log here
+
+    // Machine-readable stats: a record every stats_export_interval cycles (0 = none) and
+    // one at the end of run(). JSON lines for .json/.jsonl, CSV for .csv.
+    std::string stats_export_path;
+    cycle_t stats_export_interval = 0;
+    // Sets the fields above from "<file>[:<cycles>]" (the -O option).
+    // Throws std::invalid_argument on a malformed spec.
+    void parseStatsExportSpec(const std::string &spec);
+
+    // Number of address-interleaved bus slices and how cores reach them
+    unsigned int bus_slices = 1;
+    InterconnectTopology topology = InterconnectTopology::Bus;
+    // Sets the fields above from "<slices>[:bus|ring|crossbar]" (the -B option).
+    // Throws std::invalid_argument on a malformed spec.
+    void parseInterconnectSpec(const std::string &spec);
+
+    // Bus arbitration. arbitration_order lists cores highest priority first (priority);
+    // arbitration_weights gives each core's QoS share (weighted). Empty = defaults.
+    ArbitrationPolicy arbitration = ArbitrationPolicy::RoundRobin;
+    std::vector<int> arbitration_order;
+    std::vector<unsigned int> arbitration_weights;
+    bool demand_first = false; // Demand misses win over queued writebacks
+    // Sets the fields above from "<policy>[:<c0>,<c1>,...][:demand-first]" (the -a option).
+    // Throws std::invalid_argument on a malformed spec.
+    void parseArbitrationSpec(const std::string &spec);
+    // Report bus waits per core, and each core's slowdown against a run of its trace
+    // alone (one extra simulation per core, so traces must be rereadable files)
+    bool fairness_report = false;
+    // Only this core reads its trace; the others stay idle (used for the alone runs)
+    int solo_core = -1;
+
+    // Core i runs in address space i instead of all cores sharing ASID 0 (a manifest's
+    // asid= entries override this per core)
+    bool private_address_spaces = false;
+    // Optional translation of ASID-tagged addresses to physical frames before the caches
+    PageMapPolicy page_map = PageMapPolicy::None;
+    unsigned int page_bits = 12;           // 4 KiB pages
+    uint64_t page_map_seed = 0x9e3779b97f4a7c15ull; // Random frame allocation
+    // Sets page_map and page_bits from "<policy>[:<page_bits>]" (the -P option).
+    // Throws std::invalid_argument on a malformed spec.
+    void parsePageMapSpec(const std::string &spec);
+
+    // Optional private L2 per core, same block size as the L1 (l2_E = 0 means none)
+    unsigned int l2_s = 0;
+    unsigned int l2_E = 0;
+    ReplacementPolicy l2_replacement = ReplacementPolicy::LRU;
+    bool l2_inclusive = true;
+    // Sets the L2 fields from "<s>:<E>[:lru|fifo|random][:inclusive|noninclusive]" (the -2 option).
+    // Throws std::invalid_argument on a malformed spec.
+    void parseL2Spec(const std::string &spec);
+
+    // Throws std::invalid_argument describing the first bad field
+    void validate() const;
+};
+
+#endif
@@ -3,30 +3,126 @@
 #include <limits>   
 #include <algorithm> 
 #include <stdexcept> 
-Simulator::Simulator(unsigned int s_bits, unsigned int E_assoc, unsigned int b_bits,
-                     const std::string &trace_name, const std::string &outfile) : s(s_bits), E(E_assoc), b(b_bits),
-                                                                                  block_size(1 << b_bits),
-                                                                                  trace_base_name(trace_name),
-                                                                                  output_file(outfile)
+#include <csignal>
+#include "checkpoint.h"
+
+namespace
 {
-    if (block_size == 0 || E == 0)
-    {
-        throw std::runtime_error("Block size and associativity must be > 0.");
-    }
+// Set from the SIGUSR1 handler, consumed at the next cycle boundary
+volatile std::sig_atomic_t checkpoint_requested = 0;
+
+void requestCheckpoint(int)
+{
+    checkpoint_requested = 1;
+}
+}
+
+Simulator::Simulator(const SimConfig &sim_config) : config(sim_config)
+{
+    config.validate();
+    block_size = 1u << config.b;
 
     // Create Bus first (needs block size and stats)
-    bus = std::make_unique<Bus>(block_size, &statistics);
+    bus = std::make_unique<Interconnect>(config.bus_slices, config.topology, block_size, &statistics, config.latency);
+    bus->setArbitration(config.arbitration, config.arbitration_order, config.arbitration_weights, config.demand_first);
+    bus->setSectors(config.sectors);
 
     // Create Caches (need bus and stats)
     for (int i = 0; i < NUM_CORES; ++i)
     {
-        caches.push_back(std::make_unique<Cache>(i, s, E, b, bus.get(), &statistics));
+        caches.push_back(std::make_unique<Cache>(i, config.s, config.E, config.b, bus.get(), &statistics));
+        caches.back()->setWritebackBufferEntries(config.writeback_buffer_entries);
+        caches.back()->setSectors(config.sectors);
+        caches.back()->setCompression(config.compression, config.compression_tags,
+                                      config.latency.decompression_latency, config.compression_seed);
+        if (config.l2_E > 0)
+        {
+            caches.back()->setL2(std::make_unique<L2Cache>(config.l2_s, config.l2_E, config.b, config.l2_replacement),
+                                 config.l2_inclusive, config.latency.l2_hit_latency);
+        }
+        caches.back()->setInsertionPolicy(config.insertion);
+        caches.back()->setWayPrediction(config.way_prediction, config.partial_tag_bits, config.latency.way_mispredict_penalty);
+        caches.back()->setVictimCache(config.victim_cache_entries, config.latency.victim_hit_latency);
+        caches.back()->setSnoopFilter(config.snoop_filter);
+    }
+
+    statistics.writeback_buffer_enabled = config.writeback_buffer_entries > 0;
+    statistics.store_buffer_enabled = config.store_buffer_entries > 0;
+    statistics.snoop_filter_enabled = config.snoop_filter != SnoopFilterKind::None;
+    statistics.l2_enabled = config.l2_E > 0;
+    statistics.sectoring_enabled = config.sectors > 1;
+    statistics.compression_enabled = config.compression != CompressionModel::None;
+    statistics.victim_cache_enabled = config.victim_cache_entries > 0;
+    statistics.insertion_enabled = config.insertion != InsertionPolicy::LRU;
+    statistics.insertion_dueling = config.insertion == InsertionPolicy::DIP;
+    statistics.way_prediction_enabled = config.way_prediction != WayPrediction::None;
+    statistics.l1_hit_latency = config.latency.hit_latency;
+    statistics.fairness_enabled = config.fairness_report;
+
+    if (!config.event_log_path.empty())
+    {
+        event_log = std::make_unique<EventLog>(config.event_log_path);
+        statistics.event_log_enabled = true;
+        bus->setEventLog(event_log.get());
+        for (const auto &cache : caches)
+        {
+            cache->setEventLog(event_log.get());
+        }
+    }
+
+    if (config.page_map != PageMapPolicy::None)
+    {
+        page_map = std::make_unique<PageMap>(config.page_map, config.page_bits, config.page_map_seed);
+        statistics.page_map_enabled = true;
     }
 
     // Create Cores (need cache and stats)
+    std::shared_ptr<TraceDemux> stdin_demux;
+    std::vector<CoreStreamSpec> manifest;
+    if (!config.manifest_path.empty())
+    {
+        manifest = loadTraceManifest(config.manifest_path, NUM_CORES);
+    }
     for (int i = 0; i < NUM_CORES; ++i)
     {
-        std::string filename = trace_base_name + "_proc" + std::to_string(i) + ".trace";
+        if (config.solo_core >= 0 && i != config.solo_core)
+        {
+            cores.push_back(std::make_unique<Core>(i, caches[i].get(), &statistics));
+            cores.back()->closeInput();
+            continue;
+        }
+        if (!manifest.empty())
+        {
+            if (manifest[i].traces.empty())
+            {
+                // Not in the manifest: an idle core with no input
+                cores.push_back(std::make_unique<Core>(i, caches[i].get(), &statistics));
+                cores.back()->closeInput();
+            }
+            else
+            {
+                cores.push_back(std::make_unique<Core>(i, std::make_unique<ManifestTraceReader>(manifest[i]), caches[i].get(), &statistics));
+                cores.back()->setStartCycle(manifest[i].start_cycle);
+            }
+            continue;
+        }
+        if (config.trace_base_name.empty())
+        {
+            cores.push_back(std::make_unique<Core>(i, caches[i].get(), &statistics));
+            continue;
+        }
+        if (config.trace_base_name == "-")
+        {
+            // One binary stream on stdin, records tagged with their core id
+            if (!stdin_demux)
+            {
+                stdin_demux = TraceDemux::openStdin(NUM_CORES);
+            }
+            cores.push_back(std::make_unique<Core>(i, stdin_demux->streamFor(i), caches[i].get(), &statistics));
+            continue;
+        }
+
+        std::string filename = config.trace_base_name + "_proc" + std::to_string(i) + ".trace";
         try
         {
             cores.push_back(std::make_unique<Core>(i, filename, caches[i].get(), &statistics));
@@ -39,6 +135,52 @@ Simulator::Simulator(unsigned int s_bits, unsigned int E_assoc, unsigned int b_b
         }
     }
     // Bus registration is now handled inside Cache constructor.
+
+    for (int i = 0; i < NUM_CORES; ++i)
+    {
+        cores[i]->setHitLatency(config.latency.hit_latency);
+        cores[i]->setStoreBufferEntries(config.store_buffer_entries);
+        asid_t asid = config.private_address_spaces ? static_cast<asid_t>(i) : 0;
+        if (!manifest.empty() && manifest[i].asid >= 0)
+        {
+            asid = static_cast<asid_t>(manifest[i].asid);
+        }
+        cores[i]->setAddressSpace(asid, page_map.get());
+    }
+
+    if (!config.restore_path.empty())
+    {
+        restoreCheckpoint(config.restore_path);
+    }
+    if (!config.checkpoint_path.empty())
+    {
+        enableCheckpoints(config.checkpoint_path, config.checkpoint_interval);
+    }
+    if (!config.stats_export_path.empty())
+    {
+        stats_export = std::make_unique<StatsExportFile>(config.stats_export_path);
+    }
+    host_start = std::chrono::steady_clock::now();
+}
+
+namespace
+{
+SimConfig makeConfig(unsigned int s_bits, unsigned int E_assoc, unsigned int b_bits,
+                     const std::string &trace_name, const std::string &outfile)
+{
+    SimConfig config;
+    config.s = s_bits;
+    config.E = E_assoc;
+    config.b = b_bits;
+    config.trace_base_name = trace_name;
+    config.output_file = outfile;
+    return config;
+}
+}
+
+Simulator::Simulator(unsigned int s_bits, unsigned int E_assoc, unsigned int b_bits,
+                     const std::string &trace_name, const std::string &outfile) : Simulator(makeConfig(s_bits, E_assoc, b_bits, trace_name, outfile))
+{
 }
 
 bool Simulator::checkCompletion()
@@ -56,47 +198,251 @@ bool Simulator::checkCompletion()
 void Simulator::run()
 {
     // std::cout << "Starting simulation..." << std::endl;
-    global_cycle = 0; // Start at cycle 1
+    // global_cycle starts at 0 (first simulated cycle is 1) unless restored from a checkpoint
+#ifdef L1SIM_PROFILE
+    HostProfile before = host_profile;
+    auto run_start = std::chrono::steady_clock::now();
+    profileStart();
+#endif
+    while (step())
+    {
+    }
+#ifdef L1SIM_PROFILE
+    profileFlush();
+    statistics.profile_enabled = true;
+    statistics.host_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+    for (int zone = 0; zone < PROFILE_ZONE_COUNT; ++zone)
+    {
+        statistics.host_profile.ticks[zone] = host_profile.ticks[zone] - before.ticks[zone];
+        statistics.host_profile.calls[zone] = host_profile.calls[zone] - before.calls[zone];
+    }
+#endif
+    if (config.fairness_report)
+    {
+        measureAloneCycles();
+    }
+    if (stats_export)
+    {
+        exportStats();
+    }
+    // std::cout << "Simulation finished at cycle " << global_cycle << std::endl;
+}
 
-    while (true)
+bool Simulator::step()
+{
+    if (finished)
     {
-        global_cycle++;
+        return false;
+    }
 
-        // 1. Tick the bus (handles ongoing transactions, arbitration for *next* cycle's grant)
-        bus->tick(global_cycle);
+    global_cycle++;
 
-        // 2. Tick each core (fetch/execute or handle stalls)
+    // 1. Tick the bus (handles ongoing transactions, arbitration for *next* cycle's grant)
+    bus->tick(global_cycle);
+    for (const auto &cache : caches)
+    {
+        cache->tick(global_cycle);
+    }
+
+    // 2. Tick each core (fetch/execute or handle stalls)
+    for (const auto &core : cores)
+    {
+        if (!core->isFinished())
+        {
+            core->tick(global_cycle);
+        }
+    }
+
+    // 3. Check for completion AFTER ticking everything for the current cycle
+    if (checkCompletion())
+    {
+        // Record final cycle counts for each core
+        for (int i = 0; i < NUM_CORES; ++i)
+        {
+            // The stat total_cycles will store this global end cycle.
+            statistics.setCoreCycles(i, global_cycle);
+            statistics.finish_cycles[i] = cores[i]->getCycle();
+        }
+        finished = true; // All cores finished their traces and resolved pending misses
+        return false;
+    }
+
+    if (!config.checkpoint_path.empty() &&
+        (checkpoint_requested || (config.checkpoint_interval != 0 && global_cycle % config.checkpoint_interval == 0)))
+    {
+        checkpoint_requested = 0;
+        saveCheckpoint(config.checkpoint_path);
+    }
+    if (stats_export && config.stats_export_interval != 0 && global_cycle % config.stats_export_interval == 0)
+    {
+        exportStats();
+    }
+    return true;
+}
+
+void Simulator::measureAloneCycles()
+{
+    for (int i = 0; i < NUM_CORES; ++i)
+    {
+        SimConfig solo = config;
+        solo.solo_core = i;
+        solo.fairness_report = false;
+        solo.checkpoint_path.clear();
+        solo.checkpoint_interval = 0;
+        solo.restore_path.clear();
+        solo.event_log_path.clear();
+        solo.stats_export_path.clear();
+        solo.stats_export_interval = 0;
+
+        Simulator alone(solo);
+        alone.run();
+        if (alone.getCoreStats(i).accesses > 0)
+        {
+            statistics.alone_cycles[i] = alone.cores[i]->getCycle();
+        }
+    }
+}
+
+void Simulator::pushAccess(int core_id, const MemAccess &access)
+{
+    cores.at(core_id)->pushAccess(access);
+}
+
+void Simulator::closeInput(int core_id)
+{
+    cores.at(core_id)->closeInput();
+}
+
+void Simulator::runUntilInputNeeded()
+{
+    while (!finished)
+    {
         for (const auto &core : cores)
         {
-            if (!core->isFinished())
+            if (core->needsInput())
             {
-                core->tick(global_cycle);
+                return;
             }
         }
+        step();
+    }
+}
+
+CoreStatsSummary Simulator::getCoreStats(int core_id) const
+{
+    if (core_id < 0 || core_id >= NUM_CORES)
+    {
+        throw std::out_of_range("Invalid core id " + std::to_string(core_id));
+    }
+    return statistics.coreSummary(core_id);
+}
+
+void Simulator::enableCheckpoints(const std::string &path, cycle_t interval)
+{
+    config.checkpoint_path = path;
+    config.checkpoint_interval = interval;
+    std::signal(SIGUSR1, requestCheckpoint);
+}
+
+void Simulator::saveCheckpoint(const std::string &path) const
+{
+    CheckpointWriter out(path);
+    out.put<uint32_t>(config.s);
+    out.put<uint32_t>(config.E);
+    out.put<uint32_t>(config.b);
+    out.put<uint32_t>(NUM_CORES);
+    out.put(global_cycle);
+
+    statistics.saveState(out);
+    out.put<uint8_t>(page_map != nullptr);
+    if (page_map)
+    {
+        page_map->saveState(out);
+    }
+    bus->saveState(out);
+    for (const auto &cache : caches)
+    {
+        cache->saveState(out);
+    }
+    for (const auto &core : cores)
+    {
+        core->saveState(out);
+    }
+    out.commit();
+    std::cerr << "Checkpoint written to " << path << " at cycle " << global_cycle << std::endl;
+}
+
+void Simulator::restoreCheckpoint(const std::string &path)
+{
+    CheckpointReader in(path);
+    if (in.get<uint32_t>() != config.s || in.get<uint32_t>() != config.E || in.get<uint32_t>() != config.b || in.get<uint32_t>() != NUM_CORES)
+    {
+        throw std::runtime_error("Checkpoint " + path + " was taken with a different cache configuration.");
+    }
+    global_cycle = in.get<cycle_t>();
+
+    statistics.loadState(in);
+    if (in.get<uint8_t>() != (page_map != nullptr))
+    {
+        throw std::runtime_error("Checkpoint was taken with a different page mapping.");
+    }
+    if (page_map)
+    {
+        page_map->loadState(in);
+    }
+    bus->loadState(in);
+    for (const auto &cache : caches)
+    {
+        cache->loadState(in);
+    }
+    for (const auto &core : cores)
+    {
+        core->loadState(in);
+    }
+}
 
-        // 3. Check for completion AFTER ticking everything for the current cycle
-        if (checkCompletion())
+void Simulator::collectStats()
+{
+    if (statistics.compression_enabled)
+    {
+        for (int i = 0; i < NUM_CORES; ++i)
         {
-            // Record final cycle counts for each core *before* breaking
-            for (int i = 0; i < NUM_CORES; ++i)
-            {
-                // The stat total_cycles will store this global end cycle.
-                statistics.setCoreCycles(i, global_cycle);
-            }
-            // std::cout << "Simulation finished at cycle " << global_cycle << std::endl;
-            break; // All cores finished their traces and resolved pending misses
+            statistics.resident_blocks[i] = caches[i]->residentBlocks();
+        }
+    }
+    if (statistics.insertion_dueling)
+    {
+        for (int i = 0; i < NUM_CORES; ++i)
+        {
+            statistics.insertion_selector[i] = caches[i]->insertionSelector();
         }
     }
+    if (page_map)
+    {
+        statistics.pages_mapped = page_map->mappedPages();
+    }
+    if (event_log)
+    {
+        statistics.event_log_events = event_log->getEventCount();
+        statistics.event_log_hash = event_log->getHash();
+    }
+}
 
-    // std::cout << "Simulation finished at cycle " << global_cycle << std::endl;
+void Simulator::exportStats()
+{
+    collectStats();
+    double host_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - host_start).count();
+    statistics.exportTo(stats_export->getSink(), bus.get(), global_cycle, host_seconds);
+    stats_export->flush();
 }
 
 void Simulator::printStats() {
+    collectStats();
     statistics.printFinalStats(
-        trace_base_name,
-        s,
-        E,
-        b,
+        config.manifest_path.empty() ? config.trace_base_name : config.manifest_path,
+        config.s,
+        config.E,
+        config.b,
         bus.get() // Pass raw pointer to the Bus object
     );
 }
@@ -9,29 +9,66 @@
 #include "cache.h"
 #include "bus.h"
 #include "stats.h"
+#include "sim_config.h"
+#include "event_log.h"
+#include "trace_manifest.h"
+#include "stats_export.h"
+#include <chrono>
 
 class Simulator {
 private:
-    // Configuration
-    unsigned int s, E, b; // Cache parameters
+    SimConfig config;
     unsigned int block_size;
-    std::string trace_base_name;
-    std::string output_file;
 
     Stats statistics;
-    std::unique_ptr<Bus> bus;
+    std::unique_ptr<EventLog> event_log;
+    std::unique_ptr<PageMap> page_map; // Null unless a page mapping policy is set
+    std::unique_ptr<Interconnect> bus;
     std::vector<std::unique_ptr<Cache>> caches;
     std::vector<std::unique_ptr<Core>> cores;
+    std::unique_ptr<StatsExportFile> stats_export; // Null unless -O was given
+    std::chrono::steady_clock::time_point host_start; // For the host throughput rates
 
     cycle_t global_cycle = 0;
+    bool finished = false;
 
     bool checkCompletion(); // Checks if all cores are finished
+    // Runs each core's trace on its own and records its finish cycle for the fairness report
+    void measureAloneCycles();
+    // Copies counters kept outside Stats (page table size, event log, resident blocks) into it
+    void collectStats();
+    void exportStats();
 
 public:
+    // Validates config, builds the bus/caches/cores and applies restore/checkpoint settings
+    explicit Simulator(const SimConfig& sim_config);
     Simulator(unsigned int s_bits, unsigned int E_assoc, unsigned int b_bits,
               const std::string& trace_name, const std::string& outfile = "");
 
+    // Runs until every core has finished
     void run();
+    // Simulates one cycle. Returns false once every core has finished.
+    bool step();
+
+    // Push-mode input, for simulators configured without a trace base name
+    void pushAccess(int core_id, const MemAccess& access);
+    void closeInput(int core_id);
+    // Steps until every core has finished or some pushed core has drained its queue
+    void runUntilInputNeeded();
+    bool isFinished() const { return finished; }
+    cycle_t getCurrentCycle() const { return global_cycle; }
+
+    const Stats& getStats() const { return statistics; }
+    const SimConfig& getConfig() const { return config; }
+    // Transactions across all bus slices so far
+    uint64_t getBusTransactions() const { return bus->getTotalTransactions(); }
+    CoreStatsSummary getCoreStats(int core_id) const;
+
+    // Snapshot the full state to path every interval cycles (0 = never) and whenever SIGUSR1 arrives
+    void enableCheckpoints(const std::string& path, cycle_t interval);
+    void saveCheckpoint(const std::string& path) const;
+    // Must be called before run(); the geometry has to match the one that wrote the snapshot
+    void restoreCheckpoint(const std::string& path);
 
     void printStats();
 
@@ -0,0 +1,89 @@
+#include "snoop_filter.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+// Two independent multiplicative hashes select a block's slots
+const uint32_t BLOOM_HASH_A = 0x9E3779B1u;
+const uint32_t BLOOM_HASH_B = 0x85EBCA77u;
+}
+
+SnoopFilterKind parseSnoopFilterKind(const std::string &name)
+{
+    if (name == "none")
+    {
+        return SnoopFilterKind::None;
+    }
+    if (name == "bloom")
+    {
+        return SnoopFilterKind::Bloom;
+    }
+    if (name == "directory")
+    {
+        return SnoopFilterKind::Directory;
+    }
+    throw std::invalid_argument("Unknown snoop filter '" + name + "' (expected none, bloom or directory).");
+}
+
+SnoopFilter::SnoopFilter(SnoopFilterKind filter_kind, unsigned int lines) : kind(filter_kind)
+{
+    if (kind == SnoopFilterKind::Bloom)
+    {
+        slot_bits = 6;
+        while ((1u << slot_bits) < 4ull * lines && slot_bits < 24)
+        {
+            slot_bits++;
+        }
+        counters.assign(1u << slot_bits, 0);
+    }
+}
+
+void SnoopFilter::insert(addr_t block_addr)
+{
+    if (kind == SnoopFilterKind::Bloom)
+    {
+        counters[slot(block_addr, BLOOM_HASH_A)]++;
+        counters[slot(block_addr, BLOOM_HASH_B)]++;
+    }
+    else if (kind == SnoopFilterKind::Directory)
+    {
+        resident[block_addr]++;
+    }
+}
+
+void SnoopFilter::remove(addr_t block_addr)
+{
+    if (kind == SnoopFilterKind::Bloom)
+    {
+        counters[slot(block_addr, BLOOM_HASH_A)]--;
+        counters[slot(block_addr, BLOOM_HASH_B)]--;
+    }
+    else if (kind == SnoopFilterKind::Directory)
+    {
+        auto it = resident.find(block_addr);
+        if (it != resident.end() && --it->second == 0)
+        {
+            resident.erase(it);
+        }
+    }
+}
+
+bool SnoopFilter::mayContain(addr_t block_addr) const
+{
+    if (kind == SnoopFilterKind::Bloom)
+    {
+        return counters[slot(block_addr, BLOOM_HASH_A)] != 0 && counters[slot(block_addr, BLOOM_HASH_B)] != 0;
+    }
+    if (kind == SnoopFilterKind::Directory)
+    {
+        return resident.count(block_addr) != 0;
+    }
+    return true;
+}
+
+void SnoopFilter::clear()
+{
+    std::fill(counters.begin(), counters.end(), 0);
+    resident.clear();
+}
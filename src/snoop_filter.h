@@ -0,0 +1,47 @@
+#ifndef SNOOP_FILTER_H
+#define SNOOP_FILTER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "defs.h"
+
+// How a cache screens incoming snoops before looking at its tags
+enum class SnoopFilterKind {
+    None,     // Every snoop reaches the tag array
+    Bloom,    // Counting Bloom filter: no false negatives, occasional false positives
+    Directory // Exact copy of the resident block addresses
+};
+
+// Throws std::invalid_argument for anything other than "none", "bloom" or "directory"
+SnoopFilterKind parseSnoopFilterKind(const std::string &name);
+
+// Set of block addresses a cache may hold (valid lines plus buffered writebacks).
+// The owning cache inserts a block each time it gains a copy and removes it each time
+// it loses one, so a block may be counted more than once.
+class SnoopFilter {
+private:
+    SnoopFilterKind kind;
+    std::vector<uint16_t> counters;                // Bloom: one counter per slot
+    unsigned int slot_bits = 0;                    // Bloom: log2(counters.size())
+    std::unordered_map<addr_t, uint32_t> resident; // Directory: copies per block
+
+    unsigned int slot(addr_t block_addr, uint32_t multiplier) const
+    {
+        // Fold the ASID into the (always zero) block offset bits before hashing
+        uint32_t key = static_cast<uint32_t>(block_addr ^ (block_addr >> ASID_SHIFT));
+        return (key * multiplier) >> (32 - slot_bits);
+    }
+
+public:
+    // Bloom filters get the next power of two >= 4 * lines counters
+    SnoopFilter(SnoopFilterKind filter_kind, unsigned int lines);
+
+    void insert(addr_t block_addr);
+    void remove(addr_t block_addr);
+    bool mayContain(addr_t block_addr) const;
+    void clear();
+};
+
+#endif
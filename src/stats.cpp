@@ -1,5 +1,8 @@
 #include "stats.h"
 #include "bus.h"
+#include "interconnect.h"
+#include "checkpoint.h"
+#include "stats_export.h"
 #include <numeric>
 #include <cmath>
 #include <iomanip>
@@ -16,7 +19,37 @@ Stats::Stats() : read_instructions(NUM_CORES, 0),
                  stall_cycles(NUM_CORES, 0),
 
                  invalidations_received(NUM_CORES, 0),
-                 data_traffic_caused_bytes(NUM_CORES, 0)
+                 data_traffic_caused_bytes(NUM_CORES, 0),
+                 writeback_buffer_full_stalls(NUM_CORES, 0),
+                 writeback_buffer_snoop_hits(NUM_CORES, 0),
+                 store_buffer_full_stalls(NUM_CORES, 0),
+                 store_buffer_forwards(NUM_CORES, 0),
+                 l2_accesses(NUM_CORES, 0),
+                 l2_misses(NUM_CORES, 0),
+                 l2_back_invalidations(NUM_CORES, 0),
+                 l2_snoops_filtered(NUM_CORES, 0),
+                 miss_service_cycles(NUM_CORES, 0),
+                 sector_misses(NUM_CORES, 0),
+                 decompressions(NUM_CORES, 0),
+                 decompression_cycles(NUM_CORES, 0),
+                 resident_blocks(NUM_CORES, 0),
+                 victim_lookups(NUM_CORES, 0),
+                 victim_hits(NUM_CORES, 0),
+                 victim_bus_saved(NUM_CORES, 0),
+                 insertion_fills(NUM_CORES, 0),
+                 low_priority_fills(NUM_CORES, 0),
+                 low_priority_reused(NUM_CORES, 0),
+                 dead_evictions(NUM_CORES, 0),
+                 insertion_selector(NUM_CORES, 0),
+                 way_predictions(NUM_CORES, 0),
+                 way_predictions_correct(NUM_CORES, 0),
+                 tag_comparisons(NUM_CORES, 0),
+                 tag_comparisons_avoided(NUM_CORES, 0),
+                 bus_grants(NUM_CORES, 0),
+                 bus_wait_cycles(NUM_CORES, 0),
+                 bus_max_wait(NUM_CORES, 0),
+                 finish_cycles(NUM_CORES, 0),
+                 alone_cycles(NUM_CORES, 0)
 {
 } // Other global stats default to 0
 
@@ -87,12 +120,485 @@ void Stats::incrementStallCycles(int coreId, cycle_t cycles)
     stall_cycles[coreId] += cycles;
 }
 
+void Stats::recordWritebackBufferFull(int coreId)
+{
+    writeback_buffer_full_stalls[coreId]++;
+}
+
+void Stats::recordWritebackBufferSnoopHit(int coreId)
+{
+    writeback_buffer_snoop_hits[coreId]++;
+}
+
+void Stats::recordStoreBufferFull(int coreId)
+{
+    store_buffer_full_stalls[coreId]++;
+}
+
+void Stats::recordStoreBufferForward(int coreId)
+{
+    store_buffer_forwards[coreId]++;
+}
+
+void Stats::recordL2Access(int coreId, bool hit)
+{
+    l2_accesses[coreId]++;
+    if (!hit)
+    {
+        l2_misses[coreId]++;
+    }
+}
+
+void Stats::recordL2BackInvalidation(int coreId)
+{
+    l2_back_invalidations[coreId]++;
+}
+
+void Stats::recordL2SnoopFiltered(int coreId)
+{
+    l2_snoops_filtered[coreId]++;
+}
+
+void Stats::recordMissService(int coreId, cycle_t cycles)
+{
+    miss_service_cycles[coreId] += cycles;
+}
+
+void Stats::recordSectorMiss(int coreId)
+{
+    sector_misses[coreId]++;
+}
+
+void Stats::recordSectorBytesSaved(uint64_t bytes)
+{
+    sector_bytes_saved += bytes;
+}
+
+void Stats::recordDecompression(int coreId, cycle_t cycles)
+{
+    decompressions[coreId]++;
+    decompression_cycles[coreId] += cycles;
+}
+
+void Stats::recordCompressedFill(uint64_t uncompressed_bytes, uint64_t compressed_bytes)
+{
+    uncompressed_fill_bytes += uncompressed_bytes;
+    compressed_fill_bytes += compressed_bytes;
+}
+
+void Stats::recordVictimCacheLookup(int coreId, bool hit)
+{
+    victim_lookups[coreId]++;
+    if (hit)
+    {
+        victim_hits[coreId]++;
+    }
+}
+
+void Stats::recordVictimCacheBusSaved(int coreId, uint64_t transactions)
+{
+    victim_bus_saved[coreId] += transactions;
+}
+
+void Stats::recordInsertion(int coreId, bool low_priority)
+{
+    insertion_fills[coreId]++;
+    if (low_priority)
+    {
+        low_priority_fills[coreId]++;
+    }
+}
+
+void Stats::recordLowPriorityReuse(int coreId)
+{
+    low_priority_reused[coreId]++;
+}
+
+void Stats::recordDeadEviction(int coreId)
+{
+    dead_evictions[coreId]++;
+}
+
+void Stats::recordWayPrediction(int coreId, bool correct)
+{
+    way_predictions[coreId]++;
+    if (correct)
+    {
+        way_predictions_correct[coreId]++;
+    }
+}
+
+void Stats::recordTagComparisons(int coreId, uint64_t compared, uint64_t avoided)
+{
+    tag_comparisons[coreId] += compared;
+    tag_comparisons_avoided[coreId] += avoided;
+}
+
+void Stats::recordSnoopFilterLookup(bool passed)
+{
+    snoop_filter_lookups++;
+    if (!passed)
+    {
+        snoops_filtered++;
+    }
+}
+
+void Stats::recordBusGrant(int coreId, cycle_t wait)
+{
+    bus_grants[coreId]++;
+    bus_wait_cycles[coreId] += wait;
+    bus_max_wait[coreId] = std::max(bus_max_wait[coreId], wait);
+}
+
+void Stats::recordSnoopFilterFalsePositive()
+{
+    snoop_filter_false_positives++;
+}
+
+void Stats::recordDramRowAccess(bool row_hit)
+{
+    if (row_hit)
+    {
+        dram_row_hits++;
+    }
+    else
+    {
+        dram_row_misses++;
+    }
+}
+
+void Stats::recordDramRead(cycle_t latency)
+{
+    dram_reads++;
+    dram_read_cycles += latency;
+}
+
+void Stats::recordDramWrite(bool queue_was_full)
+{
+    dram_writes++;
+    if (queue_was_full)
+    {
+        dram_queue_full_stalls++;
+    }
+}
+
+CoreStatsSummary Stats::coreSummary(int coreId) const
+{
+    CoreStatsSummary summary;
+    summary.reads = read_instructions[coreId];
+    summary.writes = write_instructions[coreId];
+    summary.accesses = cache_accesses[coreId];
+    summary.misses = cache_misses[coreId];
+    summary.miss_rate = (summary.accesses == 0) ? 0.0 : static_cast<double>(summary.misses) / summary.accesses;
+    summary.evictions = cache_evictions[coreId];
+    summary.writebacks = writebacks[coreId];
+    summary.invalidations_received = invalidations_received[coreId];
+    summary.data_traffic_bytes = data_traffic_caused_bytes[coreId];
+    summary.execution_cycles = total_cycles[coreId];
+    summary.idle_cycles = stall_cycles[coreId];
+    return summary;
+}
+
+void Stats::saveState(CheckpointWriter &out) const
+{
+    out.putVector(read_instructions);
+    out.putVector(write_instructions);
+    out.putVector(total_cycles);
+    out.putVector(cache_misses);
+    out.putVector(cache_accesses);
+    out.putVector(cache_evictions);
+    out.putVector(writebacks);
+    out.putVector(invalidations_received);
+    out.putVector(data_traffic_caused_bytes);
+    out.putVector(stall_cycles);
+    out.putVector(writeback_buffer_full_stalls);
+    out.putVector(writeback_buffer_snoop_hits);
+    out.putVector(store_buffer_full_stalls);
+    out.putVector(store_buffer_forwards);
+    out.putVector(l2_accesses);
+    out.putVector(l2_misses);
+    out.putVector(l2_back_invalidations);
+    out.putVector(l2_snoops_filtered);
+    out.putVector(miss_service_cycles);
+    out.putVector(sector_misses);
+    out.putVector(decompressions);
+    out.putVector(decompression_cycles);
+    out.putVector(bus_grants);
+    out.putVector(bus_wait_cycles);
+    out.putVector(bus_max_wait);
+    out.putVector(victim_lookups);
+    out.putVector(victim_hits);
+    out.putVector(victim_bus_saved);
+    out.putVector(insertion_fills);
+    out.putVector(low_priority_fills);
+    out.putVector(low_priority_reused);
+    out.putVector(dead_evictions);
+    out.putVector(way_predictions);
+    out.putVector(way_predictions_correct);
+    out.putVector(tag_comparisons);
+    out.putVector(tag_comparisons_avoided);
+    out.put(total_invalidations);
+    out.put(total_bus_traffic_bytes);
+    out.put(sector_bytes_saved);
+    out.put(uncompressed_fill_bytes);
+    out.put(compressed_fill_bytes);
+    out.put(snoop_filter_lookups);
+    out.put(snoops_filtered);
+    out.put(snoop_filter_false_positives);
+    out.put(dram_reads);
+    out.put(dram_writes);
+    out.put(dram_row_hits);
+    out.put(dram_row_misses);
+    out.put(dram_read_cycles);
+    out.put(dram_queue_full_stalls);
+}
+
+void Stats::loadState(CheckpointReader &in)
+{
+    read_instructions = in.getVector<uint64_t>();
+    write_instructions = in.getVector<uint64_t>();
+    total_cycles = in.getVector<cycle_t>();
+    cache_misses = in.getVector<uint64_t>();
+    cache_accesses = in.getVector<uint64_t>();
+    cache_evictions = in.getVector<uint64_t>();
+    writebacks = in.getVector<uint64_t>();
+    invalidations_received = in.getVector<uint64_t>();
+    data_traffic_caused_bytes = in.getVector<uint64_t>();
+    stall_cycles = in.getVector<cycle_t>();
+    writeback_buffer_full_stalls = in.getVector<uint64_t>();
+    writeback_buffer_snoop_hits = in.getVector<uint64_t>();
+    store_buffer_full_stalls = in.getVector<uint64_t>();
+    store_buffer_forwards = in.getVector<uint64_t>();
+    l2_accesses = in.getVector<uint64_t>();
+    l2_misses = in.getVector<uint64_t>();
+    l2_back_invalidations = in.getVector<uint64_t>();
+    l2_snoops_filtered = in.getVector<uint64_t>();
+    miss_service_cycles = in.getVector<cycle_t>();
+    sector_misses = in.getVector<uint64_t>();
+    decompressions = in.getVector<uint64_t>();
+    decompression_cycles = in.getVector<cycle_t>();
+    bus_grants = in.getVector<uint64_t>();
+    bus_wait_cycles = in.getVector<cycle_t>();
+    bus_max_wait = in.getVector<cycle_t>();
+    victim_lookups = in.getVector<uint64_t>();
+    victim_hits = in.getVector<uint64_t>();
+    victim_bus_saved = in.getVector<uint64_t>();
+    insertion_fills = in.getVector<uint64_t>();
+    low_priority_fills = in.getVector<uint64_t>();
+    low_priority_reused = in.getVector<uint64_t>();
+    dead_evictions = in.getVector<uint64_t>();
+    way_predictions = in.getVector<uint64_t>();
+    way_predictions_correct = in.getVector<uint64_t>();
+    tag_comparisons = in.getVector<uint64_t>();
+    tag_comparisons_avoided = in.getVector<uint64_t>();
+    total_invalidations = in.get<uint64_t>();
+    total_bus_traffic_bytes = in.get<uint64_t>();
+    sector_bytes_saved = in.get<uint64_t>();
+    uncompressed_fill_bytes = in.get<uint64_t>();
+    compressed_fill_bytes = in.get<uint64_t>();
+    snoop_filter_lookups = in.get<uint64_t>();
+    snoops_filtered = in.get<uint64_t>();
+    snoop_filter_false_positives = in.get<uint64_t>();
+    dram_reads = in.get<uint64_t>();
+    dram_writes = in.get<uint64_t>();
+    dram_row_hits = in.get<uint64_t>();
+    dram_row_misses = in.get<uint64_t>();
+    dram_read_cycles = in.get<cycle_t>();
+    dram_queue_full_stalls = in.get<uint64_t>();
+}
+
+void Stats::exportTo(StatsSink &sink, const Interconnect *bus, cycle_t current_cycle, double host_seconds) const
+{
+    uint64_t total_accesses = std::accumulate(cache_accesses.begin(), cache_accesses.end(), uint64_t(0));
+    auto ratio = [](double numerator, double denominator) { return denominator == 0 ? 0.0 : numerator / denominator; };
+
+    sink.beginRecord();
+    sink.field("cycle", static_cast<uint64_t>(current_cycle));
+    sink.field("host_seconds", host_seconds);
+    sink.field("cycles_per_host_second", ratio(current_cycle, host_seconds));
+    sink.field("accesses_per_host_second", ratio(total_accesses, host_seconds));
+
+    for (int i = 0; i < NUM_CORES; ++i)
+    {
+        sink.beginGroup("core" + std::to_string(i));
+        sink.field("reads", read_instructions[i]);
+        sink.field("writes", write_instructions[i]);
+        sink.field("accesses", cache_accesses[i]);
+        sink.field("execution_cycles", static_cast<uint64_t>(total_cycles[i]));
+        sink.field("idle_cycles", static_cast<uint64_t>(stall_cycles[i]));
+        sink.field("misses", cache_misses[i]);
+        sink.field("miss_rate", ratio(cache_misses[i], cache_accesses[i]));
+        sink.field("evictions", cache_evictions[i]);
+        sink.field("writebacks", writebacks[i]);
+        sink.field("invalidations_received", invalidations_received[i]);
+        sink.field("data_traffic_bytes", data_traffic_caused_bytes[i]);
+        sink.field("amat", cache_accesses[i] == 0 ? 0.0 : l1_hit_latency + ratio(miss_service_cycles[i], cache_accesses[i]));
+        if (writeback_buffer_enabled)
+        {
+            sink.field("writeback_buffer_full_stalls", writeback_buffer_full_stalls[i]);
+            sink.field("writeback_buffer_snoop_hits", writeback_buffer_snoop_hits[i]);
+        }
+        if (store_buffer_enabled)
+        {
+            sink.field("store_buffer_full_stalls", store_buffer_full_stalls[i]);
+            sink.field("store_buffer_forwards", store_buffer_forwards[i]);
+        }
+        if (l2_enabled)
+        {
+            sink.field("l2_accesses", l2_accesses[i]);
+            sink.field("l2_misses", l2_misses[i]);
+            sink.field("l2_miss_rate", ratio(l2_misses[i], l2_accesses[i]));
+            sink.field("l2_back_invalidations", l2_back_invalidations[i]);
+            sink.field("l2_snoops_filtered", l2_snoops_filtered[i]);
+        }
+        if (sectoring_enabled)
+        {
+            sink.field("sector_misses", sector_misses[i]);
+        }
+        if (compression_enabled)
+        {
+            sink.field("decompressions", decompressions[i]);
+            sink.field("decompression_cycles", static_cast<uint64_t>(decompression_cycles[i]));
+            sink.field("resident_blocks", resident_blocks[i]);
+        }
+        if (victim_cache_enabled)
+        {
+            sink.field("victim_lookups", victim_lookups[i]);
+            sink.field("victim_hits", victim_hits[i]);
+            sink.field("victim_hit_rate", ratio(victim_hits[i], victim_lookups[i]));
+            sink.field("victim_bus_transactions_saved", victim_bus_saved[i]);
+        }
+        if (insertion_enabled)
+        {
+            sink.field("fills", insertion_fills[i]);
+            sink.field("low_priority_fills", low_priority_fills[i]);
+            sink.field("low_priority_rate", ratio(low_priority_fills[i], insertion_fills[i]));
+            sink.field("dead_evictions", dead_evictions[i]);
+            sink.field("low_priority_reused", low_priority_reused[i]);
+            sink.field("dead_prediction_accuracy", ratio(dead_evictions[i], dead_evictions[i] + low_priority_reused[i]));
+            if (insertion_dueling)
+            {
+                sink.field("insertion_selector", insertion_selector[i]);
+            }
+        }
+        if (way_prediction_enabled)
+        {
+            sink.field("way_predictions", way_predictions[i]);
+            sink.field("way_prediction_accuracy", ratio(way_predictions_correct[i], way_predictions[i]));
+            sink.field("tag_comparisons", tag_comparisons[i]);
+            sink.field("tag_comparisons_avoided", tag_comparisons_avoided[i]);
+        }
+        if (fairness_enabled)
+        {
+            sink.field("bus_grants", bus_grants[i]);
+            sink.field("average_bus_wait", ratio(bus_wait_cycles[i], bus_grants[i]));
+            sink.field("max_bus_wait", static_cast<uint64_t>(bus_max_wait[i]));
+            sink.field("finish_cycle", static_cast<uint64_t>(finish_cycles[i]));
+            sink.field("alone_cycles", static_cast<uint64_t>(alone_cycles[i]));
+            sink.field("slowdown", ratio(finish_cycles[i], alone_cycles[i]));
+        }
+        sink.endGroup();
+    }
+
+    sink.beginGroup("bus");
+    cycle_t busy_cycles = 0;
+    if (bus)
+    {
+        for (size_t k = 0; k < bus->sliceCount(); ++k)
+        {
+            busy_cycles += bus->slice(k).getBusyCycles();
+        }
+    }
+    size_t slice_count = bus ? bus->sliceCount() : 1;
+    sink.field("transactions", bus ? bus->getTotalTransactions() : overall_bus_transactions);
+    sink.field("traffic_bytes", total_bus_traffic_bytes);
+    sink.field("invalidations", total_invalidations);
+    sink.field("utilization", ratio(busy_cycles, static_cast<double>(current_cycle) * slice_count));
+    if (sectoring_enabled)
+    {
+        sink.field("sector_bytes_saved", sector_bytes_saved);
+    }
+    sink.endGroup();
+    if (bus && bus->sliceCount() > 1)
+    {
+        for (size_t k = 0; k < bus->sliceCount(); ++k)
+        {
+            sink.beginGroup("slice" + std::to_string(k));
+            sink.field("transactions", bus->slice(k).getTotalTransactions());
+            sink.field("utilization", ratio(bus->slice(k).getBusyCycles(), current_cycle));
+            sink.endGroup();
+        }
+    }
+
+    if (compression_enabled)
+    {
+        sink.beginGroup("compression");
+        sink.field("uncompressed_fill_bytes", uncompressed_fill_bytes);
+        sink.field("compressed_fill_bytes", compressed_fill_bytes);
+        sink.field("ratio", ratio(uncompressed_fill_bytes, compressed_fill_bytes));
+        sink.endGroup();
+    }
+    if (snoop_filter_enabled)
+    {
+        sink.beginGroup("snoop_filter");
+        sink.field("lookups", snoop_filter_lookups);
+        sink.field("filtered", snoops_filtered);
+        sink.field("hit_rate", ratio(snoops_filtered, snoop_filter_lookups));
+        sink.field("false_positives", snoop_filter_false_positives);
+        sink.field("false_positive_rate", ratio(snoop_filter_false_positives, snoop_filter_lookups - snoops_filtered));
+        sink.endGroup();
+    }
+    if (dram_enabled)
+    {
+        sink.beginGroup("dram");
+        sink.field("reads", dram_reads);
+        sink.field("writes", dram_writes);
+        sink.field("row_hits", dram_row_hits);
+        sink.field("row_misses", dram_row_misses);
+        sink.field("row_hit_rate", ratio(dram_row_hits, dram_row_hits + dram_row_misses));
+        sink.field("average_read_latency", ratio(dram_read_cycles, dram_reads));
+        sink.field("write_queue_full_stalls", dram_queue_full_stalls);
+        sink.endGroup();
+    }
+    if (page_map_enabled)
+    {
+        sink.beginGroup("page_map");
+        sink.field("pages_mapped", pages_mapped);
+        sink.endGroup();
+    }
+    if (profile_enabled)
+    {
+        uint64_t total_ticks = 0;
+        for (int zone = 0; zone < PROFILE_ZONE_COUNT; ++zone)
+        {
+            total_ticks += host_profile.ticks[zone];
+        }
+        static const char *share_names[PROFILE_ZONE_COUNT] = {"trace_read_share", "cache_access_share", "arbitration_share",
+                                                              "snooping_share", "transaction_start_share", "other_share"};
+        sink.beginGroup("profile");
+        sink.field("run_seconds", host_seconds);
+        for (int zone = 0; zone < PROFILE_ZONE_COUNT; ++zone)
+        {
+            sink.field(share_names[zone], ratio(host_profile.ticks[zone], total_ticks));
+        }
+        sink.endGroup();
+    }
+    if (event_log_enabled)
+    {
+        sink.beginGroup("event_log");
+        sink.field("events", event_log_events);
+        sink.field("hash", event_log_hash);
+        sink.endGroup();
+    }
+    sink.endRecord();
+}
+
 void Stats::printFinalStats(
     const std::string &trace_prefix,
     unsigned int s,
     unsigned int E,
     unsigned int b,
-    const Bus *bus)
+    const Interconnect *bus)
 {
 
     unsigned long long block_size_bytes = 1ULL << b;
@@ -121,7 +627,17 @@ void Stats::printFinalStats(
     std::cout << "  MESI Protocol: Enabled" << std::endl;
     std::cout << "  Write Policy: Write-back, Write-allocate" << std::endl;
     std::cout << "  Replacement Policy: LRU" << std::endl;
-    std::cout << "  Bus: Central snooping bus" << std::endl;
+    if (!bus || (bus->sliceCount() == 1 && bus->getTopology() == InterconnectTopology::Bus))
+    {
+        std::cout << "  Bus: Central snooping bus" << std::endl;
+    }
+    else
+    {
+        static const char *topology_names[] = {"shared bus", "ring", "crossbar"};
+        std::cout << "  Bus: " << bus->sliceCount() << " address-interleaved snooping slice" << (bus->sliceCount() == 1 ? "" : "s") << ", "
+                  << topology_names[static_cast<int>(bus->getTopology())]
+                  << " (hop latency " << bus->getHopLatency() << ")" << std::endl;
+    }
     std::cout << std::endl;
 
     // --- Print Per-Core Statistics ---
@@ -146,6 +662,73 @@ void Stats::printFinalStats(
         // *** ADDED Per-Core Bus Stats ***
         std::cout << "  Bus Invalidations Received: " << invalidations_received[i] << std::endl;
         std::cout << "  Data Traffic Caused (Bytes): " << data_traffic_caused_bytes[i] << std::endl;
+        if (writeback_buffer_enabled)
+        {
+            std::cout << "  Writeback Buffer Full Stalls: " << writeback_buffer_full_stalls[i] << std::endl;
+            std::cout << "  Writeback Buffer Snoop Hits: " << writeback_buffer_snoop_hits[i] << std::endl;
+        }
+        if (store_buffer_enabled)
+        {
+            std::cout << "  Store Buffer Full Stalls: " << store_buffer_full_stalls[i] << std::endl;
+            std::cout << "  Store Buffer Forwarded Loads: " << store_buffer_forwards[i] << std::endl;
+        }
+        if (l2_enabled)
+        {
+            uint64_t accesses = read_instructions[i] + write_instructions[i];
+            double l2_miss_percent = (l2_accesses[i] == 0) ? 0.0 : (static_cast<double>(l2_misses[i]) / l2_accesses[i]) * 100.0;
+            double amat = (accesses == 0) ? 0.0 : l1_hit_latency + static_cast<double>(miss_service_cycles[i]) / accesses;
+            std::cout << "  L2 Accesses: " << l2_accesses[i] << std::endl;
+            std::cout << "  L2 Misses: " << l2_misses[i] << std::endl;
+            std::cout << "  L2 Miss Rate: " << std::fixed << std::setprecision(2) << l2_miss_percent << "%" << std::endl;
+            std::cout << "  L2 Back-Invalidations: " << l2_back_invalidations[i] << std::endl;
+            std::cout << "  Snoops Filtered by L2: " << l2_snoops_filtered[i] << std::endl;
+            std::cout << "  AMAT (Cycles): " << std::fixed << std::setprecision(2) << amat << std::endl;
+        }
+        if (sectoring_enabled)
+        {
+            std::cout << "  Sector Misses: " << sector_misses[i] << std::endl;
+        }
+        if (compression_enabled)
+        {
+            std::cout << "  Decompressions: " << decompressions[i] << std::endl;
+            std::cout << "  Decompression Cycles: " << decompression_cycles[i] << std::endl;
+            std::cout << "  Resident Blocks: " << resident_blocks[i] << " (" << std::fixed << std::setprecision(2)
+                      << static_cast<double>(resident_blocks[i]) / num_sets << " per set, E = " << E << ")" << std::endl;
+        }
+        if (victim_cache_enabled)
+        {
+            double victim_hit_percent = (victim_lookups[i] == 0) ? 0.0 : (static_cast<double>(victim_hits[i]) / victim_lookups[i]) * 100.0;
+            std::cout << "  Victim Cache Lookups: " << victim_lookups[i] << std::endl;
+            std::cout << "  Victim Cache Hits: " << victim_hits[i] << std::endl;
+            std::cout << "  Victim Cache Hit Rate: " << std::fixed << std::setprecision(2) << victim_hit_percent << "%" << std::endl;
+            std::cout << "  Bus Transactions Saved by Victim Cache: " << victim_bus_saved[i] << std::endl;
+        }
+        if (insertion_enabled)
+        {
+            uint64_t resolved = dead_evictions[i] + low_priority_reused[i];
+            double low_priority_percent = (insertion_fills[i] == 0) ? 0.0 : (static_cast<double>(low_priority_fills[i]) / insertion_fills[i]) * 100.0;
+            double accuracy_percent = (resolved == 0) ? 0.0 : (static_cast<double>(dead_evictions[i]) / resolved) * 100.0;
+            std::cout << "  Low-Priority Fills: " << low_priority_fills[i] << " of " << insertion_fills[i]
+                      << " (" << std::fixed << std::setprecision(2) << low_priority_percent << "%)" << std::endl;
+            std::cout << "  Predicted Dead, Evicted Unused: " << dead_evictions[i] << std::endl;
+            std::cout << "  Predicted Dead, Reused: " << low_priority_reused[i] << std::endl;
+            std::cout << "  Dead-Block Prediction Accuracy: " << std::fixed << std::setprecision(2) << accuracy_percent << "%" << std::endl;
+            if (insertion_dueling)
+            {
+                std::cout << "  DIP Selector: " << insertion_selector[i] << " of " << DIP_SELECTOR_MAX
+                          << (insertion_selector[i] > DIP_SELECTOR_MAX / 2 ? " (followers use BIP)" : " (followers use LRU)") << std::endl;
+            }
+        }
+        if (way_prediction_enabled)
+        {
+            uint64_t all_ways = tag_comparisons[i] + tag_comparisons_avoided[i];
+            double accuracy_percent = (way_predictions[i] == 0) ? 0.0 : (static_cast<double>(way_predictions_correct[i]) / way_predictions[i]) * 100.0;
+            double avoided_percent = (all_ways == 0) ? 0.0 : (static_cast<double>(tag_comparisons_avoided[i]) / all_ways) * 100.0;
+            std::cout << "  Way Prediction Accuracy: " << std::fixed << std::setprecision(2) << accuracy_percent << "% ("
+                      << way_predictions_correct[i] << " of " << way_predictions[i] << " hits)" << std::endl;
+            std::cout << "  Tag Comparisons: " << tag_comparisons[i] << " (" << tag_comparisons_avoided[i] << " avoided, "
+                      << std::fixed << std::setprecision(2) << avoided_percent << "%)" << std::endl;
+        }
         std::cout << std::endl;
     }
 
@@ -153,6 +736,130 @@ void Stats::printFinalStats(
     std::cout << "Overall Bus Summary:" << std::endl;
     std::cout << "  Total Bus Transactions: " << overall_bus_transactions << std::endl;
     std::cout << "  Total Bus Traffic (Bytes): " << total_bus_traffic_bytes << std::endl;
+    if (sectoring_enabled)
+    {
+        uint64_t unsectored = total_bus_traffic_bytes + sector_bytes_saved;
+        double saved_percent = (unsectored == 0) ? 0.0 : (static_cast<double>(sector_bytes_saved) / unsectored) * 100.0;
+        std::cout << "  Traffic Saved by Sectoring (Bytes): " << sector_bytes_saved
+                  << " (" << std::fixed << std::setprecision(2) << saved_percent << "%)" << std::endl;
+    }
+    if (bus && bus->sliceCount() > 1)
+    {
+        for (size_t k = 0; k < bus->sliceCount(); ++k)
+        {
+            double utilization = (max_cycles == 0) ? 0.0 : static_cast<double>(bus->slice(k).getBusyCycles()) / max_cycles * 100.0;
+            std::cout << "  Slice " << k << ": Transactions " << bus->slice(k).getTotalTransactions()
+                      << ", Utilization " << std::fixed << std::setprecision(2) << utilization << "%" << std::endl;
+        }
+    }
     std::cout << std::endl;
 
+    if (fairness_enabled)
+    {
+        std::cout << "Bus Arbitration Summary:" << std::endl;
+        for (int i = 0; i < NUM_CORES; ++i)
+        {
+            double avg_wait = (bus_grants[i] == 0) ? 0.0 : static_cast<double>(bus_wait_cycles[i]) / bus_grants[i];
+            std::cout << "  Core " << i << ": Grants " << bus_grants[i]
+                      << ", Average Wait " << std::fixed << std::setprecision(2) << avg_wait
+                      << ", Max Wait " << bus_max_wait[i];
+            if (alone_cycles[i] > 0)
+            {
+                std::cout << ", Finished " << finish_cycles[i] << " (alone " << alone_cycles[i] << ")"
+                          << ", Slowdown " << std::fixed << std::setprecision(2)
+                          << static_cast<double>(finish_cycles[i]) / alone_cycles[i] << "x";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    if (compression_enabled)
+    {
+        double ratio = (compressed_fill_bytes == 0) ? 0.0 : static_cast<double>(uncompressed_fill_bytes) / compressed_fill_bytes;
+        std::cout << "Compression Summary:" << std::endl;
+        std::cout << "  Uncompressed Fill Bytes: " << uncompressed_fill_bytes << std::endl;
+        std::cout << "  Compressed Fill Bytes: " << compressed_fill_bytes << std::endl;
+        std::cout << "  Compression Ratio: " << std::fixed << std::setprecision(2) << ratio << std::endl;
+        std::cout << std::endl;
+    }
+
+    if (snoop_filter_enabled)
+    {
+        uint64_t passed = snoop_filter_lookups - snoops_filtered;
+        double filtered_percent = (snoop_filter_lookups == 0) ? 0.0 : (static_cast<double>(snoops_filtered) / snoop_filter_lookups) * 100.0;
+        double false_positive_percent = (passed == 0) ? 0.0 : (static_cast<double>(snoop_filter_false_positives) / passed) * 100.0;
+
+        std::cout << "Snoop Filter Summary:" << std::endl;
+        std::cout << "  Filter Lookups: " << snoop_filter_lookups << std::endl;
+        std::cout << "  Snoops Filtered: " << snoops_filtered << std::endl;
+        std::cout << "  Filter Hit Rate: " << std::fixed << std::setprecision(2) << filtered_percent << "%" << std::endl;
+        std::cout << "  False Positives: " << snoop_filter_false_positives << std::endl;
+        std::cout << "  False Positive Rate: " << std::fixed << std::setprecision(2) << false_positive_percent << "%" << std::endl;
+        std::cout << std::endl;
+    }
+
+    if (dram_enabled)
+    {
+        uint64_t row_accesses = dram_row_hits + dram_row_misses;
+        double row_hit_percent = (row_accesses == 0) ? 0.0 : (static_cast<double>(dram_row_hits) / row_accesses) * 100.0;
+        double avg_read_latency = (dram_reads == 0) ? 0.0 : static_cast<double>(dram_read_cycles) / dram_reads;
+
+        std::cout << "Memory Controller Summary:" << std::endl;
+        std::cout << "  Memory Reads: " << dram_reads << std::endl;
+        std::cout << "  Memory Writes: " << dram_writes << std::endl;
+        std::cout << "  Row Buffer Hits: " << dram_row_hits << std::endl;
+        std::cout << "  Row Buffer Misses: " << dram_row_misses << std::endl;
+        std::cout << "  Row Buffer Hit Rate: " << std::fixed << std::setprecision(2) << row_hit_percent << "%" << std::endl;
+        std::cout << "  Average Read Latency (Cycles): " << std::fixed << std::setprecision(2) << avg_read_latency << std::endl;
+        std::cout << "  Write Queue Full Stalls: " << dram_queue_full_stalls << std::endl;
+        std::cout << std::endl;
+    }
+
+    if (page_map_enabled)
+    {
+        std::cout << "Page Map Summary:" << std::endl;
+        std::cout << "  Pages Mapped: " << pages_mapped << std::endl;
+        std::cout << std::endl;
+    }
+
+    if (profile_enabled)
+    {
+        uint64_t total_ticks = 0;
+        uint64_t total_accesses = std::accumulate(cache_accesses.begin(), cache_accesses.end(), uint64_t(0));
+        for (int zone = 0; zone < PROFILE_ZONE_COUNT; ++zone)
+        {
+            total_ticks += host_profile.ticks[zone];
+        }
+        double ns_per_tick = (total_ticks == 0) ? 0.0 : host_seconds * 1e9 / total_ticks;
+
+        std::cout << "Host Profile:" << std::endl;
+        std::cout << "  Host Time (Seconds): " << std::fixed << std::setprecision(3) << host_seconds << std::endl;
+        std::cout << "  Simulated Cycles per Second: " << std::fixed << std::setprecision(0)
+                  << (host_seconds == 0 ? 0.0 : max_cycles / host_seconds) << std::endl;
+        std::cout << "  Accesses per Second: " << std::fixed << std::setprecision(0)
+                  << (host_seconds == 0 ? 0.0 : total_accesses / host_seconds) << std::endl;
+        for (int zone = 0; zone < PROFILE_ZONE_COUNT; ++zone)
+        {
+            double share = (total_ticks == 0) ? 0.0 : static_cast<double>(host_profile.ticks[zone]) / total_ticks * 100.0;
+            std::cout << "  " << profileZoneName(zone) << ": " << std::fixed << std::setprecision(2) << share << "%";
+            if (static_cast<ProfileZone>(zone) != ProfileZone::Other)
+            {
+                double ns_per_call = (host_profile.calls[zone] == 0) ? 0.0 : host_profile.ticks[zone] * ns_per_tick / host_profile.calls[zone];
+                std::cout << " (" << host_profile.calls[zone] << " calls, " << std::setprecision(1) << ns_per_call << " ns each)";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    if (event_log_enabled)
+    {
+        std::cout << "Event Log Summary:" << std::endl;
+        std::cout << "  Events Logged: " << event_log_events << std::endl;
+        std::cout << "  Rolling Hash: 0x" << std::hex << std::setw(16) << std::setfill('0') << event_log_hash
+                  << std::dec << std::setfill(' ') << std::endl;
+        std::cout << std::endl;
+    }
+
 }
\ No newline at end of file
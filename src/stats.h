@@ -3,12 +3,34 @@
 
 #include "defs.h"
 #include "bus.h"
+#include "profile.h"
+#include "insertion_policy.h"
 #include <vector>
 #include <iostream>
 #include <iomanip>
 #include <numeric>
 
+// One core's counters plus derived rates, for programmatic queries
+struct CoreStatsSummary
+{
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    uint64_t accesses = 0;
+    uint64_t misses = 0;
+    double miss_rate = 0.0; // Fraction of accesses, 0..1
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0;
+    uint64_t invalidations_received = 0;
+    uint64_t data_traffic_bytes = 0;
+    cycle_t execution_cycles = 0; // Only set once the simulation has finished
+    cycle_t idle_cycles = 0;
+};
+
 class Bus;
+class Interconnect;
+class StatsSink;
+class CheckpointWriter;
+class CheckpointReader;
 class Stats
 {
 public:
@@ -22,11 +44,112 @@ public:
     std::vector<uint64_t> invalidations_received;
     std::vector<uint64_t> data_traffic_caused_bytes;
 
+    // Writeback buffer (only reported when enabled)
+    bool writeback_buffer_enabled = false;
+    std::vector<uint64_t> writeback_buffer_full_stalls;
+    std::vector<uint64_t> writeback_buffer_snoop_hits;
+
+    // Store buffer (only reported when enabled)
+    bool store_buffer_enabled = false;
+    std::vector<uint64_t> store_buffer_full_stalls;
+    std::vector<uint64_t> store_buffer_forwards;
+
     uint64_t total_invalidations = 0;
     uint64_t total_bus_traffic_bytes = 0;
     std::vector<cycle_t> stall_cycles;
     uint64_t overall_bus_transactions = 0;
 
+    // Private L2 and AMAT (only reported when an L2 is configured)
+    bool l2_enabled = false;
+    cycle_t l1_hit_latency = L1_HIT_CYCLES; // For AMAT
+    std::vector<uint64_t> l2_accesses;
+    std::vector<uint64_t> l2_misses;
+    std::vector<uint64_t> l2_back_invalidations;
+    std::vector<uint64_t> l2_snoops_filtered;
+    std::vector<cycle_t> miss_service_cycles; // L1 miss to fill, summed
+
+    // Sectored L1 lines (only reported when enabled). A sector miss hits a valid block
+    // whose sector is absent; it is also counted in cache_misses.
+    bool sectoring_enabled = false;
+    std::vector<uint64_t> sector_misses;
+    uint64_t sector_bytes_saved = 0; // Whole-block transfer size minus the bytes actually moved
+
+    // Compressed L1 (only reported when enabled). Fill bytes compare each allocated block's
+    // size with its compressed size; resident_blocks is filled in by Simulator::printStats.
+    bool compression_enabled = false;
+    std::vector<uint64_t> decompressions;
+    std::vector<cycle_t> decompression_cycles;
+    std::vector<uint64_t> resident_blocks;
+    uint64_t uncompressed_fill_bytes = 0;
+    uint64_t compressed_fill_bytes = 0;
+
+    // Victim cache (only reported when enabled). Lookups are L1 misses that probed it; bus
+    // transactions saved counts the fills it served plus the writebacks of dirty victims
+    // it returned to the L1.
+    bool victim_cache_enabled = false;
+    std::vector<uint64_t> victim_lookups;
+    std::vector<uint64_t> victim_hits;
+    std::vector<uint64_t> victim_bus_saved;
+
+    // Insertion policy (only reported when not plain LRU). Fills are blocks allocated on a
+    // miss; a low-priority fill was predicted dead. The prediction held if the block was
+    // evicted unused and failed if it was reused. insertion_selector is filled in by
+    // Simulator::printStats and only reported for DIP.
+    bool insertion_enabled = false;
+    bool insertion_dueling = false;
+    std::vector<uint64_t> insertion_fills;
+    std::vector<uint64_t> low_priority_fills;
+    std::vector<uint64_t> low_priority_reused;
+    std::vector<uint64_t> dead_evictions;
+    std::vector<uint64_t> insertion_selector;
+
+    // Way prediction (only reported when enabled). Predictions are judged on hits; tag
+    // comparisons count every lookup, and avoided ones are against comparing all ways.
+    bool way_prediction_enabled = false;
+    std::vector<uint64_t> way_predictions;
+    std::vector<uint64_t> way_predictions_correct;
+    std::vector<uint64_t> tag_comparisons;
+    std::vector<uint64_t> tag_comparisons_avoided;
+
+    // Snoop filter (only reported when enabled)
+    bool snoop_filter_enabled = false;
+    uint64_t snoop_filter_lookups = 0;
+    uint64_t snoops_filtered = 0;
+    uint64_t snoop_filter_false_positives = 0;
+
+    // Page mapping (only reported when enabled); filled in by Simulator::printStats
+    bool page_map_enabled = false;
+    uint64_t pages_mapped = 0;
+
+    // Bus arbitration fairness (only reported when requested). Waits run from a request
+    // joining its core's bus queue to its grant. The finish and alone cycles are filled in
+    // by the Simulator; alone_cycles stays 0 for cores that ran nothing.
+    bool fairness_enabled = false;
+    std::vector<uint64_t> bus_grants;
+    std::vector<cycle_t> bus_wait_cycles;
+    std::vector<cycle_t> bus_max_wait;
+    std::vector<cycle_t> finish_cycles;
+    std::vector<cycle_t> alone_cycles;
+
+    // Replay event log (only reported when written); filled in by Simulator::printStats
+    bool event_log_enabled = false;
+    uint64_t event_log_events = 0;
+    uint64_t event_log_hash = 0;
+
+    // Host-time profile of Simulator::run (only in builds with L1SIM_PROFILE)
+    bool profile_enabled = false;
+    double host_seconds = 0.0;
+    HostProfile host_profile;
+
+    // DRAM controller (only reported when memory_model = dram)
+    bool dram_enabled = false;
+    uint64_t dram_reads = 0;
+    uint64_t dram_writes = 0;
+    uint64_t dram_row_hits = 0;
+    uint64_t dram_row_misses = 0;
+    cycle_t dram_read_cycles = 0;
+    uint64_t dram_queue_full_stalls = 0;
+
     Stats();
 
     void recordInvalidationReceived(int coreId, int count = 1);
@@ -38,13 +161,48 @@ public:
     void addBusTraffic(uint64_t bytes);
     void setCoreCycles(int coreId, cycle_t cycles);
     void incrementStallCycles(int coreId, cycle_t cycles = 1);
+    void recordWritebackBufferFull(int coreId);
+    void recordWritebackBufferSnoopHit(int coreId);
+    void recordStoreBufferFull(int coreId);
+    void recordStoreBufferForward(int coreId);
+    void recordL2Access(int coreId, bool hit);
+    void recordL2BackInvalidation(int coreId);
+    void recordL2SnoopFiltered(int coreId);
+    void recordMissService(int coreId, cycle_t cycles);
+    void recordSectorMiss(int coreId);
+    void recordSectorBytesSaved(uint64_t bytes);
+    void recordDecompression(int coreId, cycle_t cycles);
+    void recordCompressedFill(uint64_t uncompressed_bytes, uint64_t compressed_bytes);
+    void recordVictimCacheLookup(int coreId, bool hit);
+    void recordVictimCacheBusSaved(int coreId, uint64_t transactions);
+    void recordInsertion(int coreId, bool low_priority);
+    void recordLowPriorityReuse(int coreId);
+    void recordDeadEviction(int coreId);
+    void recordWayPrediction(int coreId, bool correct);
+    void recordTagComparisons(int coreId, uint64_t compared, uint64_t avoided);
+    void recordBusGrant(int coreId, cycle_t wait);
+    void recordSnoopFilterLookup(bool passed);
+    void recordSnoopFilterFalsePositive();
+    void recordDramRowAccess(bool row_hit);
+    void recordDramRead(cycle_t latency);
+    void recordDramWrite(bool queue_was_full);
+
+    CoreStatsSummary coreSummary(int coreId) const;
+
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+
+    // Writes one record with every counter plus derived rates (miss rate, AMAT, bus
+    // utilization, host throughput) to sink. Optional features add their groups only when
+    // enabled, like the text report. host_seconds is the wall-clock time simulated so far.
+    void exportTo(StatsSink &sink, const Interconnect *bus, cycle_t current_cycle, double host_seconds) const;
 
     void printFinalStats(
         const std::string &trace_prefix,
         unsigned int s,
         unsigned int E,
         unsigned int b,
-        const Bus *bus
+        const Interconnect *bus
     );
 };
 
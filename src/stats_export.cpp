@@ -0,0 +1,145 @@
+#include "stats_export.h"
+#include <iomanip>
+#include <stdexcept>
+
+namespace
+{
+bool endsWith(const std::string &text, const std::string &suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool isCsvPath(const std::string &path)
+{
+    return endsWith(path, ".csv");
+}
+}
+
+void checkStatsExportPath(const std::string &path)
+{
+    if (!endsWith(path, ".json") && !endsWith(path, ".jsonl") && !isCsvPath(path))
+    {
+        throw std::invalid_argument("Stats export file '" + path + "' must end in .json, .jsonl or .csv.");
+    }
+}
+
+StatsExportFile::StatsExportFile(const std::string &path)
+{
+    checkStatsExportPath(path);
+    file.open(path, std::ios::trunc);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot create stats export file " + path);
+    }
+    file << std::fixed << std::setprecision(6);
+    if (isCsvPath(path))
+    {
+        sink = std::make_unique<CsvStatsWriter>(file);
+    }
+    else
+    {
+        sink = std::make_unique<JsonStatsWriter>(file);
+    }
+}
+
+void JsonStatsWriter::separator()
+{
+    if (!first_field)
+    {
+        out << ',';
+    }
+    first_field = false;
+}
+
+void JsonStatsWriter::beginRecord()
+{
+    out << '{';
+    first_field = true;
+}
+
+void JsonStatsWriter::beginGroup(const std::string &name)
+{
+    separator();
+    out << '"' << name << "\":{";
+    first_field = true;
+}
+
+void JsonStatsWriter::endGroup()
+{
+    out << '}';
+    first_field = false;
+}
+
+void JsonStatsWriter::field(const char *name, uint64_t value)
+{
+    separator();
+    out << '"' << name << "\":" << value;
+}
+
+void JsonStatsWriter::field(const char *name, double value)
+{
+    separator();
+    out << '"' << name << "\":" << value;
+}
+
+void JsonStatsWriter::endRecord()
+{
+    out << "}\n";
+}
+
+void CsvStatsWriter::column(const char *name)
+{
+    if (!header_written)
+    {
+        header.push_back(group.empty() ? name : group + "." + name);
+    }
+    if (!first_field)
+    {
+        row << ',';
+    }
+    first_field = false;
+}
+
+void CsvStatsWriter::beginRecord()
+{
+    row.str("");
+    row.copyfmt(out);
+    first_field = true;
+    group.clear();
+}
+
+void CsvStatsWriter::beginGroup(const std::string &name)
+{
+    group = name;
+}
+
+void CsvStatsWriter::endGroup()
+{
+    group.clear();
+}
+
+void CsvStatsWriter::field(const char *name, uint64_t value)
+{
+    column(name);
+    row << value;
+}
+
+void CsvStatsWriter::field(const char *name, double value)
+{
+    column(name);
+    row << value;
+}
+
+void CsvStatsWriter::endRecord()
+{
+    if (!header_written)
+    {
+        for (size_t i = 0; i < header.size(); ++i)
+        {
+            out << (i ? "," : "") << header[i];
+        }
+        out << '\n';
+        header_written = true;
+    }
+    out << row.str() << '\n';
+}
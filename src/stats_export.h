@@ -0,0 +1,80 @@
+#ifndef STATS_EXPORT_H
+#define STATS_EXPORT_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include "defs.h"
+
+// Receives one record of metrics from Stats::exportTo. Fields come in groups ("core0",
+// "bus", ...); a record's groups and fields are the same for a whole run.
+class StatsSink {
+public:
+    virtual ~StatsSink() = default;
+    virtual void beginRecord() = 0;
+    virtual void beginGroup(const std::string &name) = 0;
+    virtual void endGroup() = 0;
+    virtual void field(const char *name, uint64_t value) = 0;
+    virtual void field(const char *name, double value) = 0;
+    virtual void endRecord() = 0;
+};
+
+// One JSON object per line, groups as nested objects
+class JsonStatsWriter : public StatsSink {
+private:
+    std::ostream &out;
+    bool first_field = true;
+    void separator();
+
+public:
+    explicit JsonStatsWriter(std::ostream &stream) : out(stream) {}
+    void beginRecord() override;
+    void beginGroup(const std::string &name) override;
+    void endGroup() override;
+    void field(const char *name, uint64_t value) override;
+    void field(const char *name, double value) override;
+    void endRecord() override;
+};
+
+// One row per record under a header row of "group.field" column names, written with the
+// first record
+class CsvStatsWriter : public StatsSink {
+private:
+    std::ostream &out;
+    std::string group;
+    std::vector<std::string> header; // Filled by the first record only
+    bool header_written = false;
+    std::ostringstream row;
+    bool first_field = true;
+    void column(const char *name);
+
+public:
+    explicit CsvStatsWriter(std::ostream &stream) : out(stream) {}
+    void beginRecord() override;
+    void beginGroup(const std::string &name) override;
+    void endGroup() override;
+    void field(const char *name, uint64_t value) override;
+    void field(const char *name, double value) override;
+    void endRecord() override;
+};
+
+// Opens path and picks the writer from its extension: .json/.jsonl or .csv.
+// Throws std::runtime_error if the file cannot be created, std::invalid_argument for
+// any other extension.
+class StatsExportFile {
+private:
+    std::ofstream file;
+    std::unique_ptr<StatsSink> sink;
+
+public:
+    explicit StatsExportFile(const std::string &path);
+    StatsSink &getSink() { return *sink; }
+    void flush() { file.flush(); }
+};
+
+// Throws std::invalid_argument unless path ends in .json, .jsonl or .csv
+void checkStatsExportPath(const std::string &path);
+
+#endif
@@ -0,0 +1,182 @@
+#include "trace_manifest.h"
+#include <cinttypes>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+bool parseCount(const std::string &text, uint64_t &value)
+{
+    if (text.empty() || text.size() > 18 || text.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return false;
+    }
+    value = std::stoull(text);
+    return true;
+}
+}
+
+std::vector<CoreStreamSpec> loadTraceManifest(const std::string &path, int num_cores)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::runtime_error("Could not open trace manifest: " + path);
+    }
+    std::string base_dir;
+    size_t slash = path.find_last_of('/');
+    if (slash != std::string::npos)
+    {
+        base_dir = path.substr(0, slash + 1);
+    }
+
+    std::vector<CoreStreamSpec> specs(num_cores);
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line))
+    {
+        line_no++;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string core_field;
+        if (!(fields >> core_field))
+        {
+            continue; // Blank or comment-only line
+        }
+
+        std::string where = path + ":" + std::to_string(line_no);
+        uint64_t core = 0;
+        if (!parseCount(core_field, core) || core >= static_cast<uint64_t>(num_cores))
+        {
+            throw std::runtime_error(where + ": core must be 0-" + std::to_string(num_cores - 1));
+        }
+        CoreStreamSpec &spec = specs[core];
+
+        std::string field;
+        bool has_trace = false;
+        while (fields >> field)
+        {
+            size_t eq = field.find('=');
+            if (eq == std::string::npos)
+            {
+                spec.traces.push_back((field[0] == '/' || field.rfind("unix:", 0) == 0) ? field : base_dir + field);
+                has_trace = true;
+                continue;
+            }
+            std::string key = field.substr(0, eq);
+            uint64_t value = 0;
+            if (!parseCount(field.substr(eq + 1), value))
+            {
+                throw std::runtime_error(where + ": value for '" + key + "' must be a non-negative integer");
+            }
+            if (key == "loop")
+                spec.loop_length = value;
+            else if (key == "skip")
+                spec.skip = value;
+            else if (key == "start")
+                spec.start_cycle = value;
+            else if (key == "asid" && value <= UINT16_MAX)
+                spec.asid = static_cast<int>(value);
+            else if (key == "asid")
+                throw std::runtime_error(where + ": asid must be below 65536");
+            else
+                throw std::runtime_error(where + ": unknown option '" + key + "' (expected loop, skip, start or asid)");
+        }
+        if (!has_trace)
+        {
+            throw std::runtime_error(where + ": expected at least one trace file for core " + core_field);
+        }
+    }
+    return specs;
+}
+
+ManifestTraceReader::ManifestTraceReader(const CoreStreamSpec &stream_spec) : spec(stream_spec)
+{
+    restart();
+    seek(spec.skip);
+}
+
+void ManifestTraceReader::restart()
+{
+    file_index = 0;
+    consumed = 0;
+    pass_start = 0;
+    current = spec.traces.empty() ? nullptr : TraceReader::open(spec.traces[0]);
+}
+
+bool ManifestTraceReader::nextFile()
+{
+    if (file_index + 1 < spec.traces.size())
+    {
+        file_index++;
+    }
+    else if (spec.loop_length > 0 && consumed > pass_start)
+    {
+        // Loop again, unless the last pass produced nothing (every trace empty)
+        file_index = 0;
+        pass_start = consumed;
+    }
+    else
+    {
+        current.reset();
+        return false;
+    }
+    current = TraceReader::open(spec.traces[file_index]);
+    return true;
+}
+
+bool ManifestTraceReader::readOne(char *buf, size_t size)
+{
+    if (spec.loop_length > 0 && consumed >= spec.skip + spec.loop_length)
+    {
+        return false;
+    }
+    while (current)
+    {
+        if (current->isBinary())
+        {
+            MemAccess access;
+            if (current->readRecord(access))
+            {
+                snprintf(buf, size, "%c 0x%" PRIx64 "\n", access.type == Operation::READ ? 'R' : 'W', access.address);
+                consumed++;
+                return true;
+            }
+        }
+        else if (current->readLine(buf, size))
+        {
+            consumed++;
+            return true;
+        }
+        if (!nextFile())
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+size_t ManifestTraceReader::readBytes(void *buf, size_t len)
+{
+    // Only the demultiplexer reads raw bytes, and it never wraps a manifest stream
+    (void)buf;
+    (void)len;
+    return 0;
+}
+
+bool ManifestTraceReader::readLine(char *buf, size_t size)
+{
+    return readOne(buf, size);
+}
+
+void ManifestTraceReader::seek(uint64_t offset)
+{
+    if (offset < consumed)
+    {
+        restart();
+    }
+    char discard[256];
+    while (consumed < offset && readOne(discard, sizeof(discard)))
+    {
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef TRACE_MANIFEST_H
+#define TRACE_MANIFEST_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "defs.h"
+#include "trace_reader.h"
+
+// What one core runs under a manifest: its traces back to back, optionally looped
+struct CoreStreamSpec {
+    std::vector<std::string> traces; // Empty = the core stays idle
+    uint64_t loop_length = 0;        // Repeat the traces until this many accesses (0 = play once)
+    uint64_t skip = 0;               // Accesses dropped from the front of the stream
+    cycle_t start_cycle = 0;         // The core issues nothing before this cycle
+    int asid = -1;                   // Address space of the stream (-1 = the simulator default)
+};
+
+// Reads a manifest with one line per entry:
+//   <core> <trace> [<trace> ...] [loop=<accesses>] [skip=<accesses>] [start=<cycle>] [asid=<id>]
+// Several lines for the same core append traces. Trace paths are relative to the
+// manifest's directory unless absolute. Blank lines and '#' comments are ignored.
+// Throws std::runtime_error with the offending file:line on a malformed entry.
+std::vector<CoreStreamSpec> loadTraceManifest(const std::string &path, int num_cores);
+
+// A core's manifest stream. Each trace is opened through TraceReader::open (so any
+// compressed, binary or live source works) and binary records are handed on as text
+// lines, so a core sees one text stream however the traces are stored.
+class ManifestTraceReader : public TraceReader {
+private:
+    CoreStreamSpec spec;
+    size_t file_index = 0;
+    std::unique_ptr<TraceReader> current;
+    uint64_t consumed = 0;   // Records read so far, including skipped ones
+    uint64_t pass_start = 0; // consumed when the current pass over the traces began
+
+    void restart();
+    // Moves to the next trace (wrapping around when looping); false at end of stream
+    bool nextFile();
+    bool readOne(char *buf, size_t size);
+
+public:
+    // Throws std::runtime_error if a trace cannot be opened
+    explicit ManifestTraceReader(const CoreStreamSpec &stream_spec);
+
+    size_t readBytes(void *buf, size_t len) override;
+    bool readLine(char *buf, size_t size) override;
+
+    // Position is the record count; seek() replays the stream from the start to reach it
+    uint64_t position() const override { return consumed; }
+    void seek(uint64_t offset) override;
+};
+
+#endif
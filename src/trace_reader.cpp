@@ -0,0 +1,881 @@
+#include "trace_reader.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef L1SIM_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef L1SIM_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef L1SIM_WITH_LZ4
+#include <lz4frame.h>
+#endif
+
+namespace
+{
+
+const size_t COMPRESSED_INPUT_SIZE = 64 * 1024; // Bytes fread from the compressed file at a time
+const size_t DECODE_CHUNK_SIZE = 256 * 1024;    // Decoded bytes handed to the core per chunk
+const size_t DECODE_RING_CHUNKS = 4;            // Chunks in flight between decoder thread and core
+const size_t DEMUX_QUEUE_RECORDS = DECODE_CHUNK_SIZE / TRACE_BINARY_RECORD_SIZE; // Parked records per core
+const int LIVE_POLL_TIMEOUT_MS = 100;           // How often a blocked live read checks for shutdown
+
+class PlainTraceReader : public TraceReader
+{
+private:
+    FILE *file;
+
+public:
+    explicit PlainTraceReader(FILE *f) : file(f) {}
+    ~PlainTraceReader() override { fclose(file); }
+
+    bool readLine(char *buf, size_t size) override
+    {
+        return fgets(buf, static_cast<int>(size), file) != nullptr;
+    }
+
+    size_t readBytes(void *buf, size_t len) override
+    {
+        return fread(buf, 1, len, file);
+    }
+
+    void setBinary(bool is_binary)
+    {
+        binary = is_binary;
+    }
+
+    uint64_t position() const override
+    {
+        return static_cast<uint64_t>(ftello(file));
+    }
+
+    void seek(uint64_t offset) override
+    {
+        if (fseeko(file, static_cast<off_t>(offset), SEEK_SET) != 0)
+        {
+            throw std::runtime_error("Could not seek trace file.");
+        }
+    }
+};
+
+// Turns a compressed byte stream into decoded trace text
+class StreamDecoder
+{
+public:
+    virtual ~StreamDecoder() = default;
+    // Fills out with up to cap decoded bytes. Returns 0 at end of stream, throws on corrupt input.
+    virtual size_t decode(char *out, size_t cap) = 0;
+    // Asks a decode() blocked on input to give up; called before the reader is destroyed
+    virtual void cancel() {}
+};
+
+// Pass-through "decoder" for live sources: returns whatever one read(2) delivers,
+// so records reach the core as soon as the writer produces them
+class LiveStreamDecoder : public StreamDecoder
+{
+private:
+    int fd;
+    std::atomic<bool> cancelled{false};
+    bool first_chunk = true;
+    size_t gathered = 0;
+
+public:
+    explicit LiveStreamDecoder(int file_descriptor) : fd(file_descriptor) {}
+
+    size_t decode(char *out, size_t cap) override
+    {
+        while (!cancelled)
+        {
+            pollfd pfd{fd, POLLIN, 0};
+            int ready = poll(&pfd, 1, LIVE_POLL_TIMEOUT_MS);
+            if (ready < 0 && errno != EINTR)
+            {
+                throw std::runtime_error("poll failed on live trace stream.");
+            }
+            if (ready <= 0)
+            {
+                continue;
+            }
+
+            ssize_t n = ::read(fd, out + gathered, cap - gathered);
+            if (n > 0)
+            {
+                gathered += static_cast<size_t>(n);
+                // The first chunk must hold the whole binary magic so the format can be detected
+                if (gathered >= std::min(cap, sizeof(TRACE_BINARY_MAGIC)) || !first_chunk)
+                {
+                    first_chunk = false;
+                    return std::exchange(gathered, 0);
+                }
+                continue;
+            }
+            if (n == 0)
+            {
+                first_chunk = false;
+                return std::exchange(gathered, 0); // Writer closed its end
+            }
+            if (errno != EINTR && errno != EAGAIN)
+            {
+                throw std::runtime_error("Read failed on live trace stream.");
+            }
+        }
+        return 0;
+    }
+
+    void cancel() override
+    {
+        cancelled = true;
+    }
+};
+
+#ifdef L1SIM_WITH_ZLIB
+class GzipDecoder : public StreamDecoder
+{
+private:
+    FILE *file;
+    z_stream zs{};
+    std::vector<unsigned char> in;
+    bool input_eof = false;
+    bool mid_member = false;
+
+public:
+    explicit GzipDecoder(FILE *f) : file(f), in(COMPRESSED_INPUT_SIZE)
+    {
+        // 15 + 32: largest window, accept both gzip and zlib headers
+        if (inflateInit2(&zs, 15 + 32) != Z_OK)
+        {
+            throw std::runtime_error("Could not initialise gzip decoder.");
+        }
+    }
+    ~GzipDecoder() override { inflateEnd(&zs); }
+
+    size_t decode(char *out, size_t cap) override
+    {
+        zs.next_out = reinterpret_cast<Bytef *>(out);
+        zs.avail_out = static_cast<uInt>(cap);
+
+        while (zs.avail_out > 0)
+        {
+            if (zs.avail_in == 0 && !input_eof)
+            {
+                size_t n = fread(in.data(), 1, in.size(), file);
+                input_eof = (n == 0);
+                zs.next_in = in.data();
+                zs.avail_in = static_cast<uInt>(n);
+            }
+
+            int ret = inflate(&zs, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END)
+            {
+                // A .gz file may hold several concatenated members
+                mid_member = false;
+                inflateReset(&zs);
+            }
+            else if (ret == Z_OK)
+            {
+                mid_member = true;
+            }
+            else if (ret == Z_BUF_ERROR && input_eof && zs.avail_in == 0)
+            {
+                if (mid_member)
+                {
+                    throw std::runtime_error("Truncated gzip trace.");
+                }
+                break;
+            }
+            else
+            {
+                throw std::runtime_error(std::string("Corrupt gzip trace: ") + (zs.msg ? zs.msg : "inflate failed"));
+            }
+        }
+        return cap - zs.avail_out;
+    }
+};
+#endif
+
+#ifdef L1SIM_WITH_ZSTD
+class ZstdDecoder : public StreamDecoder
+{
+private:
+    FILE *file;
+    ZSTD_DCtx *ctx;
+    std::vector<char> in;
+    ZSTD_inBuffer input{nullptr, 0, 0};
+    bool input_eof = false;
+    bool mid_frame = false;
+
+public:
+    explicit ZstdDecoder(FILE *f) : file(f), ctx(ZSTD_createDCtx()), in(COMPRESSED_INPUT_SIZE)
+    {
+        if (ctx == nullptr)
+        {
+            throw std::runtime_error("Could not initialise zstd decoder.");
+        }
+        input.src = in.data();
+    }
+    ~ZstdDecoder() override { ZSTD_freeDCtx(ctx); }
+
+    size_t decode(char *out, size_t cap) override
+    {
+        ZSTD_outBuffer output{out, cap, 0};
+
+        while (output.pos < output.size)
+        {
+            if (input.pos == input.size && !input_eof)
+            {
+                input.size = fread(in.data(), 1, in.size(), file);
+                input.pos = 0;
+                input_eof = (input.size == 0);
+            }
+
+            size_t produced_before = output.pos;
+            size_t ret = ZSTD_decompressStream(ctx, &output, &input);
+            if (ZSTD_isError(ret))
+            {
+                throw std::runtime_error(std::string("Corrupt zstd trace: ") + ZSTD_getErrorName(ret));
+            }
+            mid_frame = (ret != 0);
+
+            if (input_eof && input.pos == input.size && output.pos == produced_before)
+            {
+                if (mid_frame)
+                {
+                    throw std::runtime_error("Truncated zstd trace.");
+                }
+                break;
+            }
+        }
+        return output.pos;
+    }
+};
+#endif
+
+#ifdef L1SIM_WITH_LZ4
+class Lz4Decoder : public StreamDecoder
+{
+private:
+    FILE *file;
+    LZ4F_dctx *ctx = nullptr;
+    std::vector<char> in;
+    size_t in_pos = 0;
+    size_t in_size = 0;
+    bool input_eof = false;
+    bool mid_frame = false;
+
+public:
+    explicit Lz4Decoder(FILE *f) : file(f), in(COMPRESSED_INPUT_SIZE)
+    {
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&ctx, LZ4F_VERSION)))
+        {
+            throw std::runtime_error("Could not initialise lz4 decoder.");
+        }
+    }
+    ~Lz4Decoder() override { LZ4F_freeDecompressionContext(ctx); }
+
+    size_t decode(char *out, size_t cap) override
+    {
+        size_t produced = 0;
+
+        while (produced < cap)
+        {
+            if (in_pos == in_size && !input_eof)
+            {
+                in_size = fread(in.data(), 1, in.size(), file);
+                in_pos = 0;
+                input_eof = (in_size == 0);
+            }
+
+            size_t dst_size = cap - produced;
+            size_t src_size = in_size - in_pos;
+            size_t ret = LZ4F_decompress(ctx, out + produced, &dst_size, in.data() + in_pos, &src_size, nullptr);
+            if (LZ4F_isError(ret))
+            {
+                throw std::runtime_error(std::string("Corrupt lz4 trace: ") + LZ4F_getErrorName(ret));
+            }
+            in_pos += src_size;
+            produced += dst_size;
+            mid_frame = (ret != 0);
+
+            if (input_eof && in_pos == in_size && dst_size == 0)
+            {
+                if (mid_frame)
+                {
+                    throw std::runtime_error("Truncated lz4 trace.");
+                }
+                break;
+            }
+        }
+        return produced;
+    }
+};
+#endif
+
+// Runs a StreamDecoder on a helper thread. Decoded text travels to the core through a
+// fixed ring of chunks: the decoder blocks when the ring is full, the core when it is empty.
+class ChunkedTraceReader : public TraceReader
+{
+private:
+    struct Chunk
+    {
+        std::vector<char> data;
+        size_t length = 0;
+    };
+
+    FILE *file;
+    std::unique_ptr<StreamDecoder> decoder;
+    bool seekable; // False for live sources, which cannot be replayed
+
+    std::vector<Chunk> ring;
+    size_t filled = 0; // Decoded chunks not yet released by the reader
+    size_t write_slot = 0;
+    size_t read_slot = 0;
+    bool decoder_done = false;
+    bool stopping = false;
+    std::string decode_error;
+
+    std::mutex mtx;
+    std::condition_variable chunk_ready;
+    std::condition_variable slot_free;
+    std::thread worker;
+
+    // Reader side, only touched by the core's thread
+    bool holding_chunk = false;
+    size_t read_pos = 0;
+    uint64_t bytes_consumed = 0;
+
+    void decodeLoop()
+    {
+        try
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    slot_free.wait(lock, [this] { return filled < ring.size() || stopping; });
+                    if (stopping)
+                    {
+                        return;
+                    }
+                }
+
+                // The reader never looks at slots that are not yet filled, so no lock needed here
+                Chunk &chunk = ring[write_slot];
+                chunk.length = decoder->decode(chunk.data.data(), chunk.data.size());
+                if (chunk.length == 0)
+                {
+                    break;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    write_slot = (write_slot + 1) % ring.size();
+                    filled++;
+                }
+                chunk_ready.notify_one();
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            decode_error = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            decoder_done = true;
+        }
+        chunk_ready.notify_one();
+    }
+
+    bool acquireChunk()
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        chunk_ready.wait(lock, [this] { return filled > 0 || decoder_done; });
+        if (filled == 0)
+        {
+            if (!decode_error.empty())
+            {
+                throw std::runtime_error(decode_error);
+            }
+            return false;
+        }
+        holding_chunk = true;
+        read_pos = 0;
+        return true;
+    }
+
+    void releaseChunk()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            read_slot = (read_slot + 1) % ring.size();
+            filled--;
+        }
+        holding_chunk = false;
+        slot_free.notify_one();
+    }
+
+public:
+    ChunkedTraceReader(FILE *f, std::unique_ptr<StreamDecoder> dec, bool can_seek) : file(f),
+                                                                                      decoder(std::move(dec)),
+                                                                                      seekable(can_seek),
+                                                                                      ring(DECODE_RING_CHUNKS)
+    {
+        for (Chunk &chunk : ring)
+        {
+            chunk.data.resize(DECODE_CHUNK_SIZE);
+        }
+        worker = std::thread(&ChunkedTraceReader::decodeLoop, this);
+    }
+
+    ~ChunkedTraceReader() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        decoder->cancel();
+        slot_free.notify_one();
+        worker.join();
+        decoder.reset();
+        fclose(file);
+    }
+
+    bool readLine(char *buf, size_t size) override
+    {
+        size_t n = 0;
+        while (n + 1 < size)
+        {
+            if (!holding_chunk && !acquireChunk())
+            {
+                break;
+            }
+
+            const Chunk &chunk = ring[read_slot];
+            const char *start = chunk.data.data() + read_pos;
+            size_t want = std::min(chunk.length - read_pos, size - 1 - n);
+            const char *newline = static_cast<const char *>(memchr(start, '\n', want));
+            size_t take = newline ? static_cast<size_t>(newline - start) + 1 : want;
+
+            memcpy(buf + n, start, take);
+            n += take;
+            read_pos += take;
+            if (read_pos == chunk.length)
+            {
+                releaseChunk();
+            }
+            if (newline)
+            {
+                break;
+            }
+        }
+
+        if (n == 0)
+        {
+            return false;
+        }
+        buf[n] = '\0';
+        bytes_consumed += n;
+        return true;
+    }
+
+    size_t readBytes(void *buf, size_t len) override
+    {
+        char *out = static_cast<char *>(buf);
+        size_t n = 0;
+        while (n < len && (holding_chunk || acquireChunk()))
+        {
+            const Chunk &chunk = ring[read_slot];
+            size_t take = std::min(chunk.length - read_pos, len - n);
+            memcpy(out + n, chunk.data.data() + read_pos, take);
+            n += take;
+            read_pos += take;
+            if (read_pos == chunk.length)
+            {
+                releaseChunk();
+            }
+        }
+        bytes_consumed += n;
+        return n;
+    }
+
+    // Consumes the binary magic if the decoded stream starts with it. Only the first
+    // chunk is inspected; it is always larger than the magic unless the stream is tiny.
+    void detectBinary()
+    {
+        if (!acquireChunk())
+        {
+            return;
+        }
+        const Chunk &chunk = ring[read_slot];
+        if (chunk.length >= sizeof(TRACE_BINARY_MAGIC) &&
+            memcmp(chunk.data.data(), TRACE_BINARY_MAGIC, sizeof(TRACE_BINARY_MAGIC)) == 0)
+        {
+            binary = true;
+            read_pos = sizeof(TRACE_BINARY_MAGIC);
+            bytes_consumed = read_pos;
+            if (read_pos == chunk.length)
+            {
+                releaseChunk();
+            }
+        }
+    }
+
+    uint64_t position() const override
+    {
+        return bytes_consumed;
+    }
+
+    void seek(uint64_t offset) override
+    {
+        if (!seekable && offset != bytes_consumed)
+        {
+            throw std::runtime_error("Live trace streams cannot be resumed from a checkpoint.");
+        }
+        if (offset < bytes_consumed)
+        {
+            throw std::runtime_error("Compressed traces cannot seek backwards.");
+        }
+        // Decode and drop everything up to the target offset
+        while (bytes_consumed < offset)
+        {
+            if (!holding_chunk && !acquireChunk())
+            {
+                throw std::runtime_error("Trace ended before the checkpointed position.");
+            }
+            const Chunk &chunk = ring[read_slot];
+            size_t take = static_cast<size_t>(std::min<uint64_t>(chunk.length - read_pos, offset - bytes_consumed));
+            read_pos += take;
+            bytes_consumed += take;
+            if (read_pos == chunk.length)
+            {
+                releaseChunk();
+            }
+        }
+    }
+};
+
+const char *compressionName(TraceCompression kind)
+{
+    switch (kind)
+    {
+    case TraceCompression::Gzip:
+        return "gzip";
+    case TraceCompression::Zstd:
+        return "zstd";
+    case TraceCompression::Lz4:
+        return "lz4";
+    case TraceCompression::None:
+        break;
+    }
+    return "plain";
+}
+
+// Returns nullptr if this build was compiled without the matching library
+std::unique_ptr<StreamDecoder> makeDecoder(TraceCompression kind, FILE *f)
+{
+    switch (kind)
+    {
+#ifdef L1SIM_WITH_ZLIB
+    case TraceCompression::Gzip:
+        return std::make_unique<GzipDecoder>(f);
+#endif
+#ifdef L1SIM_WITH_ZSTD
+    case TraceCompression::Zstd:
+        return std::make_unique<ZstdDecoder>(f);
+#endif
+#ifdef L1SIM_WITH_LZ4
+    case TraceCompression::Lz4:
+        return std::make_unique<Lz4Decoder>(f);
+#endif
+    default:
+        (void)f;
+        return nullptr;
+    }
+}
+
+} // namespace
+
+TraceCompression TraceReader::detectCompression(const unsigned char *magic, size_t len)
+{
+    if (len >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+    {
+        return TraceCompression::Gzip;
+    }
+    if (len >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+    {
+        return TraceCompression::Zstd;
+    }
+    if (len >= 4 && magic[0] == 0x04 && magic[1] == 0x22 && magic[2] == 0x4d && magic[3] == 0x18)
+    {
+        return TraceCompression::Lz4;
+    }
+    return TraceCompression::None;
+}
+
+bool TraceReader::readRecord(MemAccess &out, int *core_id)
+{
+    unsigned char record[TRACE_BINARY_RECORD_SIZE];
+    size_t n = readBytes(record, sizeof(record));
+    if (n == 0)
+    {
+        return false;
+    }
+    if (n != sizeof(record))
+    {
+        throw std::runtime_error("Binary trace ends with a partial record.");
+    }
+
+    out.address = static_cast<addr_t>(record[0]) | (static_cast<addr_t>(record[1]) << 8) |
+                  (static_cast<addr_t>(record[2]) << 16) | (static_cast<addr_t>(record[3]) << 24);
+    out.type = (record[4] == 'W' || record[4] == 'w') ? Operation::WRITE : Operation::READ;
+    if (core_id)
+    {
+        *core_id = record[5];
+    }
+    return true;
+}
+
+namespace
+{
+
+// Connects to "unix:<path>" and wraps the socket as a FILE*
+FILE *connectUnixSocket(const std::string &socket_path)
+{
+    sockaddr_un addr{};
+    if (socket_path.size() >= sizeof(addr.sun_path))
+    {
+        throw std::runtime_error("Unix socket path too long: " + socket_path);
+    }
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        throw std::runtime_error("Could not connect to trace socket: " + socket_path);
+    }
+    FILE *f = fdopen(fd, "rb");
+    if (!f)
+    {
+        close(fd);
+        throw std::runtime_error("Could not open trace socket: " + socket_path);
+    }
+    return f;
+}
+
+std::unique_ptr<TraceReader> openLive(FILE *f)
+{
+    auto reader = std::make_unique<ChunkedTraceReader>(f, std::make_unique<LiveStreamDecoder>(fileno(f)), false);
+    reader->detectBinary();
+    return reader;
+}
+
+// Reader for one core's share of a TraceDemux
+class DemuxTraceReader : public TraceReader
+{
+private:
+    std::shared_ptr<TraceDemux> demux;
+    int core_id;
+    uint64_t records_read = 0;
+    bool blocked = false;
+
+public:
+    DemuxTraceReader(std::shared_ptr<TraceDemux> source, int core) : demux(std::move(source)), core_id(core)
+    {
+        binary = true;
+    }
+
+    bool readLine(char *, size_t) override
+    {
+        return false;
+    }
+
+    size_t readBytes(void *, size_t) override
+    {
+        throw std::logic_error("Multiplexed trace streams only deliver whole records.");
+    }
+
+    bool readRecord(MemAccess &out, int *core) override
+    {
+        if (!demux->next(core_id, out))
+        {
+            blocked = !demux->ended();
+            return false;
+        }
+        blocked = false;
+        records_read++;
+        if (core)
+        {
+            *core = core_id;
+        }
+        return true;
+    }
+
+    bool wouldBlock() const override
+    {
+        return blocked;
+    }
+
+    uint64_t position() const override
+    {
+        return records_read * TRACE_BINARY_RECORD_SIZE;
+    }
+
+    void seek(uint64_t offset) override
+    {
+        if (offset != position())
+        {
+            throw std::runtime_error("Live trace streams cannot be resumed from a checkpoint.");
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<TraceReader> TraceReader::open(const std::string &filename)
+{
+    const std::string socket_prefix = "unix:";
+    if (filename.compare(0, socket_prefix.size(), socket_prefix) == 0)
+    {
+        return openLive(connectUnixSocket(filename.substr(socket_prefix.size())));
+    }
+
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f)
+    {
+        throw std::runtime_error("Could not open trace file: " + filename + " (fopen failed)");
+    }
+
+    // Named FIFOs and other non-seekable inputs are read live, without compression detection
+    struct stat st;
+    if (fstat(fileno(f), &st) == 0 && !S_ISREG(st.st_mode))
+    {
+        return openLive(f);
+    }
+
+    unsigned char magic[sizeof(TRACE_BINARY_MAGIC)];
+    size_t magic_len = fread(magic, 1, sizeof(magic), f);
+    rewind(f);
+
+    TraceCompression kind = detectCompression(magic, magic_len);
+    if (kind == TraceCompression::None)
+    {
+        auto reader = std::make_unique<PlainTraceReader>(f);
+        if (magic_len == sizeof(magic) && memcmp(magic, TRACE_BINARY_MAGIC, sizeof(magic)) == 0)
+        {
+            reader->setBinary(true);
+            reader->seek(sizeof(magic));
+        }
+        return reader;
+    }
+
+    std::unique_ptr<StreamDecoder> decoder;
+    try
+    {
+        decoder = makeDecoder(kind, f);
+    }
+    catch (...)
+    {
+        fclose(f);
+        throw;
+    }
+    if (!decoder)
+    {
+        fclose(f);
+        throw std::runtime_error("Trace file " + filename + " is " + compressionName(kind) +
+                                 "-compressed, but this build has no " + compressionName(kind) + " support.");
+    }
+    auto reader = std::make_unique<ChunkedTraceReader>(f, std::move(decoder), true);
+    reader->detectBinary();
+    return reader;
+}
+
+TraceDemux::TraceDemux(std::unique_ptr<TraceReader> source, int num_streams) : input(std::move(source)),
+                                                                                queues(num_streams)
+{
+    if (!input->isBinary())
+    {
+        throw std::runtime_error("Multiplexed trace input must use the binary record format.");
+    }
+}
+
+std::shared_ptr<TraceDemux> TraceDemux::openStdin(int num_streams)
+{
+    // Work on a duplicate so closing the reader leaves the process's stdin alone
+    int fd = dup(STDIN_FILENO);
+    FILE *f = (fd >= 0) ? fdopen(fd, "rb") : nullptr;
+    if (!f)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        throw std::runtime_error("Could not open stdin for trace input.");
+    }
+    return std::make_shared<TraceDemux>(openLive(f), num_streams);
+}
+
+std::unique_ptr<TraceReader> TraceDemux::streamFor(int core_id)
+{
+    return std::make_unique<DemuxTraceReader>(shared_from_this(), core_id);
+}
+
+bool TraceDemux::anyQueueFull() const
+{
+    for (const std::deque<MemAccess> &queue : queues)
+    {
+        if (queue.size() >= DEMUX_QUEUE_RECORDS)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TraceDemux::next(int core_id, MemAccess &out)
+{
+    // Pull records until one for this core shows up; the rest wait in their core's queue.
+    // Stop pulling while a lagging core's queue is full, so the input backs up instead.
+    while (queues[core_id].empty())
+    {
+        if (input_ended || anyQueueFull())
+        {
+            return false;
+        }
+        MemAccess access;
+        int target = -1;
+        if (!input->readRecord(access, &target))
+        {
+            input_ended = true;
+            return false;
+        }
+        if (target < 0 || target >= static_cast<int>(queues.size()))
+        {
+            throw std::runtime_error("Multiplexed trace record for unknown core " + std::to_string(target));
+        }
+        queues[target].push_back(access);
+    }
+    out = queues[core_id].front();
+    queues[core_id].pop_front();
+    return true;
+}
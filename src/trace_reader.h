@@ -0,0 +1,94 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "defs.h"
+
+// Compression formats recognised from the first bytes of a trace file
+enum class TraceCompression {
+    None,
+    Gzip,
+    Zstd,
+    Lz4
+};
+
+// Binary record format, for front ends that stream accesses live. A stream starts with
+// the 8-byte TRACE_BINARY_MAGIC, followed by 8-byte little-endian records:
+//   bytes 0-3 address, byte 4 'R' or 'W', byte 5 core id (used when multiplexing), bytes 6-7 zero
+const char TRACE_BINARY_MAGIC[8] = {'L', '1', 'T', 'R', 'A', 'C', 'E', '1'};
+const size_t TRACE_BINARY_RECORD_SIZE = 8;
+
+// Reader for a single trace stream, either text lines ("R 0xADDR") or binary records.
+// Plain traces go straight through stdio. Compressed traces (.gz/.zst/.lz4) are
+// detected from their magic bytes, not the file extension, and decoded on a helper
+// thread into a small ring of fixed-size chunks, so memory use stays constant no
+// matter how large the trace is. Live sources (a named FIFO, or "unix:<path>" for a
+// Unix domain socket) go through the same ring with batched reads: the helper
+// thread stops reading once the ring is full, which pushes back on the writer.
+class TraceReader {
+protected:
+    bool binary = false;
+
+public:
+    virtual ~TraceReader() = default;
+
+    bool isBinary() const { return binary; }
+
+    // Reads up to len raw bytes, blocking until they arrive or the stream ends
+    virtual size_t readBytes(void *buf, size_t len) = 0;
+
+    // Next binary record; core_id (if given) receives the record's core field
+    virtual bool readRecord(MemAccess &out, int *core_id = nullptr);
+
+    // True if the last readRecord failed only because the next record isn't available
+    // yet; the stream has not ended, so the caller should try again later
+    virtual bool wouldBlock() const { return false; }
+
+    // Same contract as fgets: copies at most size-1 bytes up to and including '\n'
+    // and null-terminates. Returns false once the stream is exhausted.
+    virtual bool readLine(char *buf, size_t size) = 0;
+
+    // Offset into the decoded trace text, used to checkpoint and resume a core's stream
+    virtual uint64_t position() const = 0;
+    // Moves to a position previously returned by position(). Compressed streams can
+    // only move forward, so this is meant to be called right after open().
+    virtual void seek(uint64_t offset) = 0;
+
+    // Opens a trace file, picking the decoder from its magic bytes.
+    // Throws std::runtime_error if the file cannot be opened or the format is unsupported.
+    static std::unique_ptr<TraceReader> open(const std::string &filename);
+
+    static TraceCompression detectCompression(const unsigned char *magic, size_t len);
+};
+
+// Splits one binary stream whose records are tagged with a core id (e.g. stdin)
+// into per-core readers. Records for other cores are parked until those cores ask for them.
+// Each parked queue is bounded: while one is full, the input is left unread until its core
+// drains it, so a fast producer blocks instead of the simulator buffering without limit.
+class TraceDemux : public std::enable_shared_from_this<TraceDemux> {
+private:
+    std::unique_ptr<TraceReader> input;
+    std::vector<std::deque<MemAccess>> queues;
+    bool input_ended = false;
+
+    bool anyQueueFull() const;
+
+public:
+    TraceDemux(std::unique_ptr<TraceReader> source, int num_streams);
+
+    // Throws std::runtime_error unless stdin carries the binary record format
+    static std::shared_ptr<TraceDemux> openStdin(int num_streams);
+
+    std::unique_ptr<TraceReader> streamFor(int core_id);
+    // False if the input has ended, or if another core's queue is full (see ended())
+    bool next(int core_id, MemAccess &out);
+    bool ended() const { return input_ended; }
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "victim_cache.h"
+#include "checkpoint.h"
+#include <stdexcept>
+
+VictimCache::VictimCache(unsigned int entry_count) : entries(entry_count)
+{
+    if (entry_count == 0)
+    {
+        throw std::invalid_argument("A victim cache needs at least one entry.");
+    }
+}
+
+VictimCache::Entry *VictimCache::find(addr_t block_addr)
+{
+    for (Entry &entry : entries)
+    {
+        if (entry.isValid() && entry.block_addr == block_addr)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+VictimCache::Entry VictimCache::insert(addr_t block_addr, MESIState state, cycle_t current_cycle)
+{
+    // A free entry if there is one, otherwise the least recently used
+    Entry *slot = &entries[0];
+    for (Entry &entry : entries)
+    {
+        if (!entry.isValid())
+        {
+            slot = &entry;
+            break;
+        }
+        if (entry.lastUsedCycle < slot->lastUsedCycle)
+        {
+            slot = &entry;
+        }
+    }
+
+    Entry displaced = *slot;
+    slot->block_addr = block_addr;
+    slot->state = state;
+    slot->lastUsedCycle = current_cycle;
+    return displaced;
+}
+
+std::vector<addr_t> VictimCache::validBlocks() const
+{
+    std::vector<addr_t> blocks;
+    for (const Entry &entry : entries)
+    {
+        if (entry.isValid())
+        {
+            blocks.push_back(entry.block_addr);
+        }
+    }
+    return blocks;
+}
+
+void VictimCache::saveState(CheckpointWriter &out) const
+{
+    out.put<uint32_t>(static_cast<uint32_t>(entries.size()));
+    for (const Entry &entry : entries)
+    {
+        out.put(entry.block_addr);
+        out.put<uint8_t>(static_cast<uint8_t>(entry.state));
+        out.put(entry.lastUsedCycle);
+    }
+}
+
+void VictimCache::loadState(CheckpointReader &in)
+{
+    if (in.get<uint32_t>() != entries.size())
+    {
+        throw std::runtime_error("Checkpoint victim cache size does not match this configuration.");
+    }
+    for (Entry &entry : entries)
+    {
+        entry.block_addr = in.get<addr_t>();
+        entry.state = static_cast<MESIState>(in.get<uint8_t>());
+        entry.lastUsedCycle = in.get<cycle_t>();
+    }
+}
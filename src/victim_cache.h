@@ -0,0 +1,43 @@
+#ifndef VICTIM_CACHE_H
+#define VICTIM_CACHE_H
+
+#include <cstddef>
+#include <vector>
+#include "defs.h"
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Small fully associative buffer of blocks recently evicted from an L1, replaced in LRU
+// order. Like L2Cache it has no protocol logic: the Cache in front of it moves its
+// victims in, swaps them back on a miss and applies snoops to them, so each entry keeps
+// the MESI state it had in the L1 (a MODIFIED entry still owes memory a writeback).
+class VictimCache {
+public:
+    struct Entry {
+        addr_t block_addr = 0;
+        MESIState state = MESIState::INVALID;
+        cycle_t lastUsedCycle = 0;
+        bool isValid() const { return state != MESIState::INVALID; }
+    };
+
+private:
+    std::vector<Entry> entries;
+
+public:
+    explicit VictimCache(unsigned int entry_count);
+
+    // The valid entry holding block_addr, or nullptr. Setting its state to INVALID frees it.
+    Entry *find(addr_t block_addr);
+    // Places block_addr in the given state and returns the valid entry it displaced, if any
+    Entry insert(addr_t block_addr, MESIState state, cycle_t current_cycle);
+
+    size_t capacity() const { return entries.size(); }
+    // Addresses of all valid entries (used to rebuild a snoop filter)
+    std::vector<addr_t> validBlocks() const;
+
+    void saveState(CheckpointWriter &out) const;
+    void loadState(CheckpointReader &in);
+};
+
+#endif
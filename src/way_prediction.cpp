@@ -0,0 +1,19 @@
+#include "way_prediction.h"
+#include <stdexcept>
+
+WayPrediction parseWayPrediction(const std::string &name)
+{
+    if (name == "none")
+    {
+        return WayPrediction::None;
+    }
+    if (name == "mru")
+    {
+        return WayPrediction::Mru;
+    }
+    if (name == "partial")
+    {
+        return WayPrediction::PartialTag;
+    }
+    throw std::invalid_argument("Unknown way predictor '" + name + "' (expected none, mru or partial).");
+}
@@ -0,0 +1,17 @@
+#ifndef WAY_PREDICTION_H
+#define WAY_PREDICTION_H
+
+#include <string>
+
+// How an L1 lookup picks the way it reads first. A hit in that way costs the core's hit
+// latency; every further way probed before the hit costs way_mispredict_penalty more.
+enum class WayPrediction {
+    None,      // All ways are read and compared in parallel
+    Mru,       // The set's most recently used way first, then all the others
+    PartialTag // Only ways whose low tag bits match get a full tag comparison, in way order
+};
+
+// Throws std::invalid_argument for anything other than "none", "mru" or "partial"
+WayPrediction parseWayPrediction(const std::string &name);
+
+#endif